@@ -0,0 +1,582 @@
+#include "analysisServer.h"
+#include "jsonWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ANALYSIS_SERVER_SOCKETS 1
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t tab = line.find('\t', start);
+        fields.push_back(line.substr(start, tab == std::string::npos ? std::string::npos : tab - start));
+        if (tab == std::string::npos) {
+            return fields;
+        }
+        start = tab + 1;
+    }
+}
+
+// File a load or save request names, inside the data directory. Only
+// relative names without ".." are accepted, so a client cannot reach files
+// elsewhere with the server's privileges.
+std::string dataPath(const std::string& directory, const std::string& name) {
+    if (directory.empty()) {
+        throw AnalysisServerException("load and save are disabled; serve with --data-dir to enable them");
+    }
+    const std::filesystem::path relative(name);
+    if (name.empty() || relative.has_root_name() || relative.has_root_directory()) {
+        throw AnalysisServerException("File names must be relative to the data directory");
+    }
+    for (const std::filesystem::path& part : relative) {
+        if (part == "..") {
+            throw AnalysisServerException("File names must stay inside the data directory");
+        }
+    }
+    return (std::filesystem::path(directory) / relative).string();
+}
+
+std::string errorReply(const std::string& message) {
+    std::ostringstream reply;
+    reply << "{\"ok\":false,\"error\":";
+    writeJsonString(reply, message);
+    reply << "}";
+    return reply.str();
+}
+
+#ifdef ANALYSIS_SERVER_SOCKETS
+
+#ifdef MSG_NOSIGNAL
+const int kSendFlags = MSG_NOSIGNAL;  // a vanished peer is an error, not SIGPIPE
+#else
+const int kSendFlags = 0;
+#endif
+
+std::string systemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+// Fill in a Unix or loopback TCP address; returns its length
+socklen_t makeAddress(const ServerAddress& address, sockaddr_storage& storage) {
+    std::memset(&storage, 0, sizeof(storage));
+    if (!address.socketPath.empty()) {
+        auto* unixAddress = reinterpret_cast<sockaddr_un*>(&storage);
+        if (address.socketPath.size() >= sizeof(unixAddress->sun_path)) {
+            throw AnalysisServerException("Socket path too long: " + address.socketPath);
+        }
+        unixAddress->sun_family = AF_UNIX;
+        std::strcpy(unixAddress->sun_path, address.socketPath.c_str());
+        return sizeof(sockaddr_un);
+    }
+    if (address.tcpPort <= 0 || address.tcpPort > 65535) {
+        throw AnalysisServerException("Need a socket path or a TCP port");
+    }
+    auto* inetAddress = reinterpret_cast<sockaddr_in*>(&storage);
+    inetAddress->sin_family = AF_INET;
+    inetAddress->sin_port = htons(static_cast<std::uint16_t>(address.tcpPort));
+    inetAddress->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return sizeof(sockaddr_in);
+}
+
+int connectTo(const ServerAddress& address) {
+    sockaddr_storage storage;
+    socklen_t length = makeAddress(address, storage);
+    int fd = ::socket(storage.ss_family, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw AnalysisServerException(systemError("Cannot create socket"));
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&storage), length) != 0) {
+        ::close(fd);
+        throw AnalysisServerException(systemError("Cannot connect to server"));
+    }
+    if (storage.ss_family == AF_INET) {
+        int noDelay = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+    return fd;
+}
+
+void sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = ::send(fd, data.data() + sent, data.size() - sent, kSendFlags);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw AnalysisServerException(systemError("Cannot send request"));
+        }
+        sent += static_cast<size_t>(written);
+    }
+}
+
+// Read up to and including the next newline; buffer keeps any surplus
+std::string receiveLine(int fd, std::string& buffer) {
+    size_t newline;
+    while ((newline = buffer.find('\n')) == std::string::npos) {
+        char chunk[4096];
+        ssize_t received = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            throw AnalysisServerException("Server closed the connection");
+        }
+        buffer.append(chunk, static_cast<size_t>(received));
+    }
+    std::string line = buffer.substr(0, newline);
+    buffer.erase(0, newline + 1);
+    return line;
+}
+
+#endif
+
+}  // namespace
+
+struct AnalysisServer::Client {
+    int fd;
+    std::string input;   // bytes received but not yet handled
+    std::string output;  // replies not yet sent
+    bool closing = false;
+    bool stalled = false;        // output has been over maxClientBytes
+    Clock::time_point stalledSince;
+
+    explicit Client(int socket) : fd(socket) {}
+};
+
+AnalysisServer::AnalysisServer(const ServerOptions& serverOptions)
+    : options(serverOptions), analyzer(serverOptions.maxQuestions), listener(-1),
+      stopping(false), batches(0), batchedPredicts(0) {
+    options.maxBatch = std::max<size_t>(options.maxBatch, 1);
+    // A line of the longest allowed length must fit in the input buffer
+    options.maxClientBytes = std::max(options.maxClientBytes, options.maxLineBytes + 1);
+    analyzer.setThreadCount(options.threads);
+    if (!options.loadFile.empty()) {
+        analyzer.loadFromFile(options.loadFile);
+    }
+}
+
+#ifdef ANALYSIS_SERVER_SOCKETS
+
+AnalysisServer::~AnalysisServer() {
+    if (listener >= 0) {
+        ::close(listener);
+        if (!options.address.socketPath.empty()) {
+            ::unlink(options.address.socketPath.c_str());
+        }
+    }
+}
+
+void AnalysisServer::listen() {
+    if (listener >= 0) {
+        return;
+    }
+    sockaddr_storage storage;
+    socklen_t length = makeAddress(options.address, storage);
+    listener = ::socket(storage.ss_family, SOCK_STREAM, 0);
+    if (listener < 0) {
+        throw AnalysisServerException(systemError("Cannot create socket"));
+    }
+    if (storage.ss_family == AF_UNIX) {
+        // A stale socket file from an earlier run would make bind fail
+        ::unlink(options.address.socketPath.c_str());
+    } else {
+        int reuse = 1;
+        ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    }
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&storage), length) != 0 ||
+        ::listen(listener, SOMAXCONN) != 0) {
+        throw AnalysisServerException(systemError("Cannot listen"));
+    }
+    ::fcntl(listener, F_SETFL, ::fcntl(listener, F_GETFL) | O_NONBLOCK);
+}
+
+// Append what the client has sent, up to maxClientBytes of unhandled input;
+// the rest waits in the socket until the lines buffered so far are
+// handled. Nothing is read while the client's replies are over the limit.
+// False once the peer has gone or has sent more than maxLineBytes without
+// ending the line.
+bool AnalysisServer::readClient(Client& client) {
+    char chunk[65536];
+    if (client.output.size() >= options.maxClientBytes) {
+        return true;
+    }
+    while (client.input.size() < options.maxClientBytes) {
+        const size_t room = std::min(sizeof(chunk), options.maxClientBytes - client.input.size());
+        ssize_t received = ::recv(client.fd, chunk, room, 0);
+        if (received > 0) {
+            client.input.append(chunk, static_cast<size_t>(received));
+            // An unterminated line past the limit would grow without bound
+            const size_t lineStart = client.input.rfind('\n');
+            const size_t partial = lineStart == std::string::npos ? client.input.size()
+                                                                   : client.input.size() - lineStart - 1;
+            if (partial > options.maxLineBytes) {
+                return false;
+            }
+            continue;
+        }
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        return received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    return true;
+}
+
+void AnalysisServer::run() {
+    listen();
+    std::vector<Client> clients;
+    std::vector<pollfd> polled;
+
+    while (!stopping) {
+        polled.clear();
+        polled.push_back({listener, POLLIN, 0});
+        for (const auto& client : clients) {
+            // A client that is not reading its replies is not read from
+            short events = client.output.size() < options.maxClientBytes ? POLLIN : 0;
+            if (!client.output.empty()) {
+                events |= POLLOUT;
+            }
+            polled.push_back({client.fd, events, 0});
+        }
+
+        // The timeout bounds how long a stop request can go unnoticed
+        int ready = ::poll(polled.data(), polled.size(), 100);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw AnalysisServerException(systemError("poll failed"));
+        }
+
+        if (polled[0].revents & POLLIN) {
+            int fd;
+            while ((fd = ::accept(listener, nullptr, nullptr)) >= 0) {
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                int noDelay = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+                clients.emplace_back(fd);
+            }
+        }
+        bool received = false;
+        for (size_t c = 0; c + 1 < polled.size(); ++c) {
+            if (polled[c + 1].revents & (POLLIN | POLLHUP | POLLERR)) {
+                if (!readClient(clients[c])) {
+                    clients[c].closing = true;
+                }
+                received = true;
+            }
+        }
+
+        // Optionally hold on briefly so more predicts join the batch
+        if (received && options.batchWindowUs > 0) {
+            auto deadline = Clock::now() + std::chrono::microseconds(options.batchWindowUs);
+            for (auto now = Clock::now(); now < deadline; now = Clock::now()) {
+                int waitMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - now).count());
+                std::vector<pollfd> waiting;
+                for (const auto& client : clients) {
+                    short events = client.output.size() < options.maxClientBytes ? POLLIN : 0;
+                    waiting.push_back({client.fd, events, 0});
+                }
+                if (::poll(waiting.data(), waiting.size(), std::max(waitMs, 0)) <= 0) {
+                    break;
+                }
+                for (size_t c = 0; c < waiting.size(); ++c) {
+                    if ((waiting[c].revents & (POLLIN | POLLHUP | POLLERR)) && !readClient(clients[c])) {
+                        clients[c].closing = true;
+                    }
+                }
+            }
+        }
+
+        handleRequests(clients);
+
+        for (auto& client : clients) {
+            while (!client.output.empty()) {
+                ssize_t written = ::send(client.fd, client.output.data(), client.output.size(), kSendFlags);
+                if (written > 0) {
+                    client.output.erase(0, static_cast<size_t>(written));
+                } else {
+                    if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                        client.output.clear();
+                        client.closing = true;
+                    }
+                    break;
+                }
+            }
+
+            if (client.output.size() < options.maxClientBytes) {
+                client.stalled = false;
+            } else if (!client.stalled) {
+                client.stalled = true;
+                client.stalledSince = Clock::now();
+            } else if (Clock::now() - client.stalledSince >
+                       std::chrono::milliseconds(options.stalledClientMs)) {
+                client.output.clear();
+                client.closing = true;
+            }
+        }
+        clients.erase(std::remove_if(clients.begin(), clients.end(), [](const Client& client) {
+            if (client.closing && client.output.empty()) {
+                ::close(client.fd);
+                return true;
+            }
+            return false;
+        }), clients.end());
+    }
+
+    for (const auto& client : clients) {
+        ::close(client.fd);
+    }
+}
+
+#else
+
+AnalysisServer::~AnalysisServer() {}
+
+void AnalysisServer::listen() {
+    throw AnalysisServerException("The analysis server needs POSIX sockets");
+}
+
+bool AnalysisServer::readClient(Client&) {
+    return false;
+}
+
+void AnalysisServer::run() {
+    listen();
+}
+
+#endif
+
+// Handle every complete line received so far, batching predicts
+void AnalysisServer::handleRequests(std::vector<Client>& clients) {
+    struct PendingPredict {
+        Client* client;
+        size_t replySlot;  // index into replies
+    };
+    std::vector<std::vector<std::string>> sheets;
+    std::vector<PendingPredict> pending;
+    std::vector<std::string> replies;
+    std::vector<Client*> replyClients;
+
+    auto flushPredicts = [&]() {
+        if (sheets.empty()) {
+            return;
+        }
+        std::vector<double> scores = analyzer.predictScores(sheets);
+        for (size_t i = 0; i < pending.size(); ++i) {
+            std::ostringstream reply;
+            reply << std::setprecision(10) << "{\"ok\":true,\"predicted\":" << scores[i] << "}";
+            replies[pending[i].replySlot] = reply.str();
+        }
+        batches++;
+        batchedPredicts += sheets.size();
+        sheets.clear();
+        pending.clear();
+    };
+
+    for (auto& client : clients) {
+        size_t start = 0;
+        size_t newline;
+        while ((newline = client.input.find('\n', start)) != std::string::npos) {
+            std::string line = client.input.substr(start, newline - start);
+            start = newline + 1;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            std::vector<std::string> fields = splitFields(line);
+
+            replies.emplace_back();
+            replyClients.push_back(&client);
+            if (fields[0] == "predict") {
+                sheets.emplace_back(fields.begin() + 1, fields.end());
+                pending.push_back({&client, replies.size() - 1});
+                if (sheets.size() >= options.maxBatch) {
+                    flushPredicts();
+                }
+            } else {
+                // Predicts received earlier must not see this request's changes
+                flushPredicts();
+                replies.back() = handleRequest(fields);
+            }
+        }
+        client.input.erase(0, start);
+    }
+    flushPredicts();
+
+    for (size_t r = 0; r < replies.size(); ++r) {
+        replyClients[r]->output += replies[r];
+        replyClients[r]->output += '\n';
+    }
+}
+
+std::string AnalysisServer::handleRequest(const std::vector<std::string>& fields) {
+    const std::string& command = fields[0];
+    std::ostringstream reply;
+    reply << std::setprecision(10);
+
+    try {
+        if (command == "add") {
+            if (fields.size() < 3) {
+                return errorReply("add needs a percentage and answers");
+            }
+            double percentage;
+            try {
+                percentage = std::stod(fields[1]);
+            } catch (const std::exception&) {
+                return errorReply("Invalid percentage: " + fields[1]);
+            }
+            analyzer.addAttempt(std::vector<std::string>(fields.begin() + 2, fields.end()), percentage);
+            reply << "{\"ok\":true,\"attempts\":" << analyzer.getNumAttempts() << "}";
+        } else if (command == "suggest") {
+            auto suggestion = analyzer.suggestNextAttempt();
+            reply << "{\"ok\":true,\"suggestion\":";
+            writeJsonStrings(reply, suggestion);
+            reply << ",\"predicted\":" << analyzer.predictScore(suggestion) << "}";
+        } else if (command == "confidences") {
+            reply << "{\"ok\":true,\"confidences\":[";
+            const auto confidences = analyzer.getAnswerConfidences();
+            for (size_t q = 0; q < confidences.size(); ++q) {
+                reply << (q > 0 ? "," : "") << "{\"answer\":";
+                writeJsonString(reply, confidences[q].first);
+                reply << ",\"confidence\":" << confidences[q].second << "}";
+            }
+            reply << "]}";
+        } else if (command == "stats") {
+            reply << "{\"ok\":true,\"attempts\":" << analyzer.getNumAttempts()
+                  << ",\"average\":" << analyzer.getAverageScore()
+                  << ",\"variance\":" << analyzer.getScoreVariance()
+                  << ",\"batches\":" << batches << ",\"batched_predicts\":" << batchedPredicts << "}";
+        } else if (command == "load" || command == "save") {
+            if (fields.size() != 2) {
+                return errorReply(command + " needs a file name");
+            }
+            const std::string path = dataPath(options.dataDirectory, fields[1]);
+            if (command == "load") {
+                analyzer.loadFromFile(path);
+            } else {
+                analyzer.saveToFile(path);
+            }
+            reply << "{\"ok\":true,\"attempts\":" << analyzer.getNumAttempts() << "}";
+        } else {
+            return errorReply("Unknown request: " + command);
+        }
+    } catch (const std::exception& e) {
+        return errorReply(e.what());
+    }
+    return reply.str();
+}
+
+#ifdef ANALYSIS_SERVER_SOCKETS
+
+std::string sendRequest(const ServerAddress& address, const std::string& request) {
+    int fd = connectTo(address);
+    try {
+        sendAll(fd, request + "\n");
+        std::string buffer;
+        std::string reply = receiveLine(fd, buffer);
+        ::close(fd);
+        return reply;
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+}
+
+LoadReport runLoadGenerator(const LoadOptions& options) {
+    std::string request = "predict";
+    for (const auto& answer : options.sheet) {
+        request += '\t';
+        request += answer;
+    }
+    request += '\n';
+
+    std::vector<std::vector<double>> latencies(options.clients);
+    std::vector<size_t> errors(options.clients, 0);
+    std::vector<std::thread> threads;
+    std::mutex failureMutex;
+    std::string failure;
+
+    auto start = Clock::now();
+    for (size_t c = 0; c < options.clients; ++c) {
+        threads.emplace_back([&, c]() {
+            try {
+                int fd = connectTo(options.address);
+                std::string buffer;
+                latencies[c].reserve(options.requestsPerClient);
+                for (size_t i = 0; i < options.requestsPerClient; ++i) {
+                    auto sent = Clock::now();
+                    sendAll(fd, request);
+                    std::string reply = receiveLine(fd, buffer);
+                    latencies[c].push_back(
+                        std::chrono::duration<double, std::micro>(Clock::now() - sent).count());
+                    if (reply.compare(0, 10, "{\"ok\":true") != 0) {
+                        errors[c]++;
+                    }
+                }
+                ::close(fd);
+            } catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(failureMutex);
+                failure = e.what();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (!failure.empty()) {
+        throw AnalysisServerException(failure);
+    }
+
+    LoadReport report;
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::vector<double> all;
+    for (size_t c = 0; c < options.clients; ++c) {
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        report.errors += errors[c];
+    }
+    report.requests = all.size();
+    if (!all.empty()) {
+        std::sort(all.begin(), all.end());
+        report.p50Us = all[(all.size() - 1) / 2];
+        report.p99Us = all[(all.size() - 1) * 99 / 100];
+        report.maxUs = all.back();
+        report.throughput = report.requests / report.seconds;
+    }
+    return report;
+}
+
+#else
+
+std::string sendRequest(const ServerAddress&, const std::string&) {
+    throw AnalysisServerException("The analysis client needs POSIX sockets");
+}
+
+LoadReport runLoadGenerator(const LoadOptions&) {
+    throw AnalysisServerException("The analysis client needs POSIX sockets");
+}
+
+#endif
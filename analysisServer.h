@@ -0,0 +1,118 @@
+#ifndef ANALYSIS_SERVER_H
+#define ANALYSIS_SERVER_H
+
+#include "answerAnalyzer.h"
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Custom exception class for AnalysisServer-specific errors
+class AnalysisServerException : public std::runtime_error {
+public:
+    explicit AnalysisServerException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+// Where the server listens or the client connects: a Unix socket path, or
+// a TCP port on 127.0.0.1 when the path is empty
+struct ServerAddress {
+    std::string socketPath;
+    int tcpPort = 0;
+};
+
+struct ServerOptions {
+    ServerAddress address;
+    size_t maxQuestions = 10;
+    size_t threads = 1;           // analyzer threads; 0 = one per core
+    size_t maxBatch = 1024;       // predict requests scored in one pass
+    int batchWindowUs = 0;        // wait this long for more predicts before scoring a batch
+    std::string loadFile;         // attempt file to load at startup, if any
+    // Directory that load and save requests name files in; empty disables
+    // them, so clients cannot touch the file system by default
+    std::string dataDirectory;
+    size_t maxLineBytes = 1 << 20;  // longer request lines drop the client
+    // Unread requests and unsent replies are each held to about this many
+    // bytes per client. A client is not read from while its replies are
+    // over the limit, and is dropped if they stay over for stalledClientMs.
+    size_t maxClientBytes = 8 << 20;
+    int stalledClientMs = 10000;
+};
+
+// Long-running analysis daemon. One AnswerAnalyzer stays resident and is
+// served over a line protocol: each request is one line of tab-separated
+// fields, each reply one line of JSON.
+//
+//   add <percentage> <answer>...   record an attempt
+//   predict <answer>...            predicted score of a sheet
+//   suggest                        suggested next sheet
+//   confidences                    top answer and confidence per question
+//   stats                          attempts, average score, variance
+//   load <file> / save <file>      replace or write the attempt history;
+//                                  relative to ServerOptions::dataDirectory
+//
+// Requests are handled on one thread in arrival order. predict requests
+// that arrive together, from any number of connections, are scored with a
+// single predictScores call; a request that changes the history first
+// flushes the predicts received before it, so every reply reflects exactly
+// the requests that came earlier.
+class AnalysisServer {
+private:
+    struct Client;
+
+    ServerOptions options;
+    AnswerAnalyzer analyzer;
+    int listener;
+    std::atomic<bool> stopping;
+    size_t batches;
+    size_t batchedPredicts;
+
+    bool readClient(Client& client);
+    void handleRequests(std::vector<Client>& clients);
+    std::string handleRequest(const std::vector<std::string>& fields);
+
+public:
+    explicit AnalysisServer(const ServerOptions& serverOptions);
+    ~AnalysisServer();
+
+    AnalysisServer(const AnalysisServer&) = delete;
+    AnalysisServer& operator=(const AnalysisServer&) = delete;
+
+    // Bind the socket; run() does this itself if it has not been done, but
+    // calling it first lets clients connect as soon as it returns
+    void listen();
+    // Serve until stop() is called from another thread or a signal handler
+    void run();
+    void stop() { stopping = true; }
+
+    // Getters
+    size_t getBatchCount() const { return batches; }
+    size_t getBatchedPredicts() const { return batchedPredicts; }
+};
+
+// Load generator: clients each keep one predict request in flight against a
+// running server and time every round trip
+struct LoadOptions {
+    ServerAddress address;
+    size_t clients = 8;
+    size_t requestsPerClient = 1000;
+    std::vector<std::string> sheet;  // answers sent with every predict
+};
+
+struct LoadReport {
+    size_t requests = 0;
+    size_t errors = 0;
+    double seconds = 0.0;
+    double throughput = 0.0;  // requests per second
+    double p50Us = 0.0;
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+};
+
+LoadReport runLoadGenerator(const LoadOptions& options);
+
+// Send one request line and return the reply line
+std::string sendRequest(const ServerAddress& address, const std::string& request);
+
+#endif
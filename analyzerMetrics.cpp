@@ -0,0 +1,124 @@
+#include "analyzerMetrics.h"
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+namespace {
+
+// Per-thread allocation tallies; plain integers, so operator new can touch
+// them on any thread without initialization order concerns
+thread_local std::uint64_t allocationCount = 0;
+thread_local std::uint64_t allocationBytes = 0;
+
+std::mutex& registryMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::vector<metrics::MethodCounter*>& registry() {
+    static std::vector<metrics::MethodCounter*> counters;
+    return counters;
+}
+
+}  // namespace
+
+#if ANALYZER_ALLOCATION_METRICS
+// Count every allocation made through the global operator new. The other
+// forms of new and delete forward to these two.
+void* operator new(std::size_t size) {
+    allocationCount++;
+    allocationBytes += size;
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        if (void* memory = std::malloc(size)) {
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+#endif
+
+namespace metrics {
+
+std::atomic<bool> collecting(false);
+
+void setEnabled(bool enable) {
+    collecting = ANALYZER_METRICS && enable;
+}
+
+MethodCounter::MethodCounter(const char* methodName)
+    : name(methodName), calls(0), totalNs(0), maxNs(0), allocations(0), allocatedBytes(0) {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    registry().push_back(this);
+}
+
+void MethodCounter::record(std::uint64_t ns, std::uint64_t allocationCount, std::uint64_t bytes) {
+    calls.fetch_add(1, std::memory_order_relaxed);
+    totalNs.fetch_add(ns, std::memory_order_relaxed);
+    allocations.fetch_add(allocationCount, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    std::uint64_t previous = maxNs.load(std::memory_order_relaxed);
+    while (ns > previous && !maxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed)) {
+    }
+}
+
+std::uint64_t threadAllocations() {
+    return allocationCount;
+}
+
+std::uint64_t threadAllocatedBytes() {
+    return allocationBytes;
+}
+
+std::vector<MethodMetrics> snapshot(const std::string& prefix) {
+    std::vector<MethodMetrics> result;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (const MethodCounter* counter : registry()) {
+            std::uint64_t calls = counter->calls.load(std::memory_order_relaxed);
+            if (calls == 0 || std::string(counter->name).compare(0, prefix.size(), prefix) != 0) {
+                continue;
+            }
+            MethodMetrics entry;
+            entry.method = counter->name;
+            entry.calls = calls;
+            entry.totalNs = counter->totalNs.load(std::memory_order_relaxed);
+            entry.maxNs = counter->maxNs.load(std::memory_order_relaxed);
+            entry.allocations = counter->allocations.load(std::memory_order_relaxed);
+            entry.allocatedBytes = counter->allocatedBytes.load(std::memory_order_relaxed);
+            result.push_back(std::move(entry));
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const MethodMetrics& a, const MethodMetrics& b) {
+        return a.method < b.method;
+    });
+    return result;
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(registryMutex());
+    for (MethodCounter* counter : registry()) {
+        counter->calls = 0;
+        counter->totalNs = 0;
+        counter->maxNs = 0;
+        counter->allocations = 0;
+        counter->allocatedBytes = 0;
+    }
+}
+
+}  // namespace metrics
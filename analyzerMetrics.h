@@ -0,0 +1,119 @@
+#ifndef ANALYZER_METRICS_H
+#define ANALYZER_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-method call counters and timers for the public AnswerAnalyzer and
+// AnswerTracker methods. Collection is off until metrics::setEnabled(true),
+// leaving one flag test per call; build with -DANALYZER_METRICS=0 to compile
+// the instrumentation out entirely, and the getMetrics() calls then return
+// nothing.
+#ifndef ANALYZER_METRICS
+#define ANALYZER_METRICS 1
+#endif
+
+// Allocation counts need the global operator new replaced, which counts
+// every allocation in the program whether or not collection is enabled, so
+// it has its own flag: build with -DANALYZER_ALLOCATION_METRICS=1 to fill
+// in MethodMetrics::allocations and allocatedBytes, which otherwise stay 0.
+#ifndef ANALYZER_ALLOCATION_METRICS
+#define ANALYZER_ALLOCATION_METRICS 0
+#endif
+
+// Totals for one instrumented method since the last reset. Times and
+// allocations are inclusive of nested instrumented calls; allocations are
+// those made on the calling thread, so work handed to the thread pool is
+// timed but its allocations are not counted.
+struct MethodMetrics {
+    std::string method;            // "Class::method", overloads suffixed by parameter
+    std::uint64_t calls = 0;
+    std::uint64_t totalNs = 0;
+    std::uint64_t maxNs = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t allocatedBytes = 0;
+};
+
+namespace metrics {
+
+// Counters of one method; instances are function-local statics that
+// register themselves on first use and live for the whole program
+class MethodCounter {
+private:
+    const char* name;
+    std::atomic<std::uint64_t> calls;
+    std::atomic<std::uint64_t> totalNs;
+    std::atomic<std::uint64_t> maxNs;
+    std::atomic<std::uint64_t> allocations;
+    std::atomic<std::uint64_t> allocatedBytes;
+
+    friend std::vector<MethodMetrics> snapshot(const std::string& prefix);
+    friend void reset();
+
+public:
+    explicit MethodCounter(const char* methodName);
+    void record(std::uint64_t ns, std::uint64_t allocationCount, std::uint64_t bytes);
+};
+
+extern std::atomic<bool> collecting;
+
+inline bool enabled() {
+    return collecting.load(std::memory_order_relaxed);
+}
+
+void setEnabled(bool enable);
+
+// Allocations made so far on the calling thread; always 0 unless built
+// with ANALYZER_ALLOCATION_METRICS
+std::uint64_t threadAllocations();
+std::uint64_t threadAllocatedBytes();
+
+// Times the enclosing scope into a counter while collection is enabled
+class ScopedTimer {
+private:
+    MethodCounter* counter;
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t allocationsAtStart = 0;
+    std::uint64_t bytesAtStart = 0;
+
+public:
+    explicit ScopedTimer(MethodCounter& methodCounter)
+        : counter(enabled() ? &methodCounter : nullptr) {
+        if (counter) {
+            allocationsAtStart = threadAllocations();
+            bytesAtStart = threadAllocatedBytes();
+            start = std::chrono::steady_clock::now();
+        }
+    }
+    ~ScopedTimer() {
+        if (!counter) {
+            return;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        counter->record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                        threadAllocations() - allocationsAtStart,
+                        threadAllocatedBytes() - bytesAtStart);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+// Methods called at least once whose name starts with prefix, by name
+std::vector<MethodMetrics> snapshot(const std::string& prefix = "");
+void reset();
+
+}  // namespace metrics
+
+#if ANALYZER_METRICS
+#define ANALYZER_PROFILE(method) \
+    static metrics::MethodCounter analyzerMethodCounter_(method); \
+    metrics::ScopedTimer analyzerScopedTimer_(analyzerMethodCounter_)
+#else
+#define ANALYZER_PROFILE(method) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,299 @@
+#include "analyzerPool.h"
+#include "threadPool.h"
+#include <algorithm>
+
+namespace {
+
+// Ingest refreshes memory figures and enforces the budget after this many
+// attempts per shard, rather than after every one
+const size_t kBudgetCheckInterval = 1024;
+
+// The pool whose callback this thread is running, if any
+thread_local const AnalyzerPool* callbackPool = nullptr;
+
+// Marks the current thread as inside a callback of pool while alive
+class CallbackScope {
+public:
+    explicit CallbackScope(const AnalyzerPool* pool) : previous(callbackPool) { callbackPool = pool; }
+    ~CallbackScope() { callbackPool = previous; }
+
+private:
+    const AnalyzerPool* previous;
+};
+
+}  // namespace
+
+AnalyzerPool::AnalyzerPool(const AnalyzerPoolOptions& poolOptions) : options(poolOptions) {
+    if (options.shardCount == 0) {
+        throw AnalyzerPoolException("An analyzer pool needs at least one shard");
+    }
+    shards.reserve(options.shardCount);
+    for (size_t s = 0; s < options.shardCount; ++s) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+    threadPool = std::make_shared<ThreadPool>(options.threads);
+}
+
+AnalyzerPool::~AnalyzerPool() = default;
+
+// A callback runs under its test's lock, and shard locks are taken before
+// test locks, so a callback reaching back into the pool could deadlock
+void AnalyzerPool::checkNotInCallback() const {
+    if (callbackPool == this) {
+        throw AnalyzerPoolException("A test callback cannot call back into its pool");
+    }
+}
+
+size_t AnalyzerPool::shardOf(const std::string& testId) const {
+    return std::hash<std::string>()(testId) % shards.size();
+}
+
+// Add one attempt to its test, creating the test on first sight. The caller
+// holds the shard lock.
+void AnalyzerPool::addToShard(Shard& shard, const TaggedAttempt& record) {
+    auto [position, inserted] = shard.tests.try_emplace(record.testId);
+    if (inserted) {
+        position->second = std::make_unique<Entry>(options.maxQuestions);
+    }
+    Entry& entry = *position->second;
+
+    try {
+        std::lock_guard<std::mutex> lock(entry.mutex);
+        entry.analyzer.addAttempt(record.answers, record.percentage);
+    } catch (...) {
+        // A test whose first attempt is refused does not exist yet
+        if (inserted) {
+            shard.tests.erase(position);
+        }
+        throw;
+    }
+    entry.lastTouched = ++shard.clock;
+}
+
+// Refresh the memory figure of every test updated since the last check and
+// compact the least recently updated tests until the shard fits its budget.
+// The caller holds the shard lock.
+void AnalyzerPool::enforceBudget(Shard& shard) {
+    size_t total = 0;
+    for (auto& [testId, entry] : shard.tests) {
+        if (entry->lastTouched > shard.checkedAt) {
+            std::lock_guard<std::mutex> lock(entry->mutex);
+            entry->memory = entry->analyzer.memoryUsage();
+        }
+        total += entry->memory;
+    }
+    shard.memory = total;
+    shard.checkedAt = shard.clock;
+    if (shard.memory <= options.shardMemoryBudget) {
+        return;
+    }
+
+    std::vector<Entry*> candidates;
+    for (auto& [testId, entry] : shard.tests) {
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        if (!entry->analyzer.isSummaryOnly()) {
+            candidates.push_back(entry.get());
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const Entry* a, const Entry* b) {
+        return a->lastTouched < b->lastTouched;
+    });
+    for (Entry* entry : candidates) {
+        if (shard.memory <= options.shardMemoryBudget) {
+            break;
+        }
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        entry->analyzer.dropAttempts();
+        size_t compacted = entry->analyzer.memoryUsage();
+        shard.memory -= entry->memory - compacted;
+        entry->memory = compacted;
+    }
+}
+
+void AnalyzerPool::addAttempt(const std::string& testId, const std::vector<std::string>& answers,
+                              double percentage) {
+    checkNotInCallback();
+    Shard& shard = *shards[shardOf(testId)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    try {
+        addToShard(shard, TaggedAttempt{testId, answers, percentage});
+    } catch (const AnswerAnalyzerException& e) {
+        throw AnalyzerPoolException("Test " + testId + ": " + e.what());
+    }
+    if (options.shardMemoryBudget > 0) {
+        enforceBudget(shard);
+    }
+}
+
+IngestStats AnalyzerPool::ingest(const std::vector<TaggedAttempt>& records) {
+    checkNotInCallback();
+    // Route first, keeping stream order within each shard
+    std::vector<std::vector<size_t>> routed(shards.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        routed[shardOf(records[i].testId)].push_back(i);
+    }
+
+    struct ShardResult {
+        size_t accepted = 0;
+        size_t rejected = 0;
+        size_t firstRejected = 0;
+        std::string firstError;
+    };
+    std::vector<ShardResult> results(shards.size());
+
+    // Shards hold very different numbers of records, hence the stealing
+    threadPool->parallelForEach(shards.size(), [&](size_t s) {
+        Shard& shard = *shards[s];
+        ShardResult& result = results[s];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (size_t n = 0; n < routed[s].size(); ++n) {
+            size_t index = routed[s][n];
+            try {
+                addToShard(shard, records[index]);
+                result.accepted++;
+            } catch (const AnswerAnalyzerException& e) {
+                if (result.rejected++ == 0) {
+                    result.firstRejected = index;
+                    result.firstError = "Test " + records[index].testId + ": " + e.what();
+                }
+            }
+            if (options.shardMemoryBudget > 0 &&
+                ((n + 1) % kBudgetCheckInterval == 0 || n + 1 == routed[s].size())) {
+                enforceBudget(shard);
+            }
+        }
+    });
+
+    IngestStats stats;
+    size_t firstRejected = records.size();
+    for (const auto& result : results) {
+        stats.accepted += result.accepted;
+        stats.rejected += result.rejected;
+        if (result.rejected > 0 && result.firstRejected < firstRejected) {
+            firstRejected = result.firstRejected;
+            stats.firstError = result.firstError;
+        }
+    }
+    return stats;
+}
+
+void AnalyzerPool::clear() {
+    checkNotInCallback();
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->tests.clear();
+        shard->memory = 0;
+        shard->clock = 0;
+        shard->checkedAt = 0;
+    }
+}
+
+// Every test with its id; entries live until clear(), so the pointers stay
+// valid while other threads add tests
+std::vector<std::pair<const std::string*, AnalyzerPool::Entry*>> AnalyzerPool::snapshot() const {
+    checkNotInCallback();
+    std::vector<std::pair<const std::string*, Entry*>> entries;
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto& [testId, entry] : shard->tests) {
+            entries.emplace_back(&testId, entry.get());
+        }
+    }
+    return entries;
+}
+
+void AnalyzerPool::forEachTest(const std::function<void(const std::string&, AnswerAnalyzer&)>& body) {
+    auto entries = snapshot();
+    threadPool->parallelForEach(entries.size(), [&](size_t i) {
+        std::lock_guard<std::mutex> lock(entries[i].second->mutex);
+        CallbackScope scope(this);
+        body(*entries[i].first, entries[i].second->analyzer);
+    });
+}
+
+std::vector<TestReport> AnalyzerPool::analyzeAll() {
+    auto entries = snapshot();
+    std::vector<TestReport> reports(entries.size());
+
+    threadPool->parallelForEach(entries.size(), [&](size_t i) {
+        TestReport& report = reports[i];
+        report.testId = *entries[i].first;
+        std::lock_guard<std::mutex> lock(entries[i].second->mutex);
+        const AnswerAnalyzer& analyzer = entries[i].second->analyzer;
+        try {
+            report.attempts = analyzer.getNumAttempts();
+            report.summaryOnly = analyzer.isSummaryOnly();
+            report.averageScore = analyzer.getAverageScore();
+            report.mostCommonAnswers = analyzer.getMostCommonAnswers();
+            if (!report.summaryOnly) {
+                analyzer.analyzeResults();
+                const auto& definite = analyzer.getDefiniteAnswers();
+                report.definiteAnswers.assign(definite.begin(),
+                    definite.begin() + std::min(definite.size(), analyzer.getFirstAttemptSize()));
+                report.modelCount = analyzer.getModelCount();
+            }
+        } catch (const std::exception& e) {
+            report.error = e.what();
+        }
+    });
+
+    std::sort(reports.begin(), reports.end(), [](const TestReport& a, const TestReport& b) {
+        return a.testId < b.testId;
+    });
+    return reports;
+}
+
+bool AnalyzerPool::withTest(const std::string& testId,
+                            const std::function<void(AnswerAnalyzer&)>& body) {
+    checkNotInCallback();
+    Shard& shard = *shards[shardOf(testId)];
+    Entry* entry;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto position = shard.tests.find(testId);
+        if (position == shard.tests.end()) {
+            return false;
+        }
+        entry = position->second.get();
+    }
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    CallbackScope scope(this);
+    body(entry->analyzer);
+    return true;
+}
+
+size_t AnalyzerPool::testCount() const {
+    checkNotInCallback();
+    size_t count = 0;
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        count += shard->tests.size();
+    }
+    return count;
+}
+
+size_t AnalyzerPool::shardMemory(size_t shard) const {
+    checkNotInCallback();
+    if (shard >= shards.size()) {
+        throw AnalyzerPoolException("Shard index out of range");
+    }
+    std::lock_guard<std::mutex> lock(shards[shard]->mutex);
+    size_t bytes = 0;
+    for (const auto& [testId, entry] : shards[shard]->tests) {
+        std::lock_guard<std::mutex> entryLock(entry->mutex);
+        bytes += entry->analyzer.memoryUsage();
+    }
+    return bytes;
+}
+
+size_t AnalyzerPool::memoryUsage() const {
+    size_t bytes = 0;
+    for (size_t s = 0; s < shards.size(); ++s) {
+        bytes += shardMemory(s);
+    }
+    return bytes;
+}
+
+size_t AnalyzerPool::getThreadCount() const {
+    return threadPool->size();
+}
@@ -0,0 +1,126 @@
+#ifndef ANALYZER_POOL_H
+#define ANALYZER_POOL_H
+
+#include "answerAnalyzer.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Custom exception class for AnalyzerPool-specific errors
+class AnalyzerPoolException : public std::runtime_error {
+public:
+    explicit AnalyzerPoolException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+// One attempt from a stream that mixes many tests
+struct TaggedAttempt {
+    std::string testId;
+    std::vector<std::string> answers;
+    double percentage;
+};
+
+// Outcome of routing a batch of tagged attempts
+struct IngestStats {
+    size_t accepted = 0;
+    size_t rejected = 0;       // attempts their test's analyzer refused
+    std::string firstError;    // reason for the first rejection, by stream order
+};
+
+// Per-test result of analyzeAll
+struct TestReport {
+    std::string testId;
+    size_t attempts = 0;
+    bool summaryOnly = false;  // compacted to stay within the shard budget
+    double averageScore = 0.0;
+    std::vector<std::string> mostCommonAnswers;
+    std::vector<std::optional<bool>> definiteAnswers;  // latest attempt; empty if summary-only
+    std::optional<double> modelCount;
+    std::string error;         // set if the analysis threw
+};
+
+struct AnalyzerPoolOptions {
+    size_t shardCount = 64;
+    size_t threads = 0;             // 0 = one per core
+    size_t maxQuestions = 10;       // passed to every analyzer
+    size_t shardMemoryBudget = 0;   // approximate bytes per shard; 0 = unbounded
+};
+
+// Registry of analyzers keyed by test id. Tests are spread over shards by a
+// hash of their id; each shard has its own lock, so ingest into different
+// shards runs in parallel. Work across tests is scheduled with the thread
+// pool's work stealing, since tests differ wildly in size.
+//
+// When a shard's analyzers grow past the memory budget, its least recently
+// updated tests are compacted to summary-only (AnswerAnalyzer::dropAttempts)
+// until it fits again: they keep their counts and score statistics and go
+// on absorbing attempts, but no longer support the attempt-level analysis.
+class AnalyzerPool {
+private:
+    struct Entry {
+        AnswerAnalyzer analyzer;
+        std::mutex mutex;        // guards analyzer; taken after the shard lock
+        size_t memory = 0;       // analyzer.memoryUsage() as of the last update
+        size_t lastTouched = 0;  // shard clock at the last update
+
+        explicit Entry(size_t maxQuestions) : analyzer(maxQuestions) {}
+    };
+
+    struct Shard {
+        std::mutex mutex;        // guards tests, memory and clock
+        std::unordered_map<std::string, std::unique_ptr<Entry>> tests;
+        size_t memory = 0;       // sum of the entries' memory figures
+        size_t clock = 0;        // counts attempts added to the shard
+        size_t checkedAt = 0;    // clock when memory was last refreshed
+    };
+
+    AnalyzerPoolOptions options;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::shared_ptr<ThreadPool> threadPool;
+
+    size_t shardOf(const std::string& testId) const;
+    void addToShard(Shard& shard, const TaggedAttempt& record);
+    void enforceBudget(Shard& shard);
+    std::vector<std::pair<const std::string*, Entry*>> snapshot() const;
+    void checkNotInCallback() const;
+
+public:
+    explicit AnalyzerPool(const AnalyzerPoolOptions& poolOptions = AnalyzerPoolOptions());
+    ~AnalyzerPool();
+
+    AnalyzerPool(const AnalyzerPool&) = delete;
+    AnalyzerPool& operator=(const AnalyzerPool&) = delete;
+
+    // Core functionality
+    void addAttempt(const std::string& testId, const std::vector<std::string>& answers,
+                    double percentage);
+    // Route a mixed stream to its tests; shards are filled in parallel and
+    // each test sees its attempts in stream order
+    IngestStats ingest(const std::vector<TaggedAttempt>& records);
+    void clear();
+
+    // Run body on every test, in parallel with work stealing. The test is
+    // locked while body runs, so it may modify the analyzer, but it must not
+    // call back into the pool: pool calls from body throw.
+    void forEachTest(const std::function<void(const std::string&, AnswerAnalyzer&)>& body);
+    // Summary and definite answers of every test, sorted by test id
+    std::vector<TestReport> analyzeAll();
+    // Run body on one test under its lock; false if the test is unknown.
+    // As with forEachTest, body must not call back into the pool.
+    bool withTest(const std::string& testId, const std::function<void(AnswerAnalyzer&)>& body);
+
+    // Getters
+    size_t testCount() const;
+    size_t shardCount() const { return shards.size(); }
+    size_t shardMemory(size_t shard) const;
+    size_t memoryUsage() const;
+    size_t getThreadCount() const;
+};
+
+#endif
@@ -1,12 +1,58 @@
 #include "answerAnalyzer.h"
+#include "answerScorer.h"
+#include "attemptJournal.h"
+#include "compressedHistory.h"
+#include "deductionEngine.h"
+#include "matchKernel.h"
+#include "threadPool.h"
+#include <random>
 #include <algorithm>
 #include <numeric>
+#include <filesystem>
 #include <fstream>
+#include <limits>
 #include <cmath>
 #include <map>
 #include <set>
 
-void AnswerAnalyzer::addAttempt(const std::vector<std::string>& answers, double percentage) {
+namespace {
+
+int popcount64(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(value);
+#else
+    int count = 0;
+    for (; value; value &= value - 1) {
+        count++;
+    }
+    return count;
+#endif
+}
+
+int lowestBit(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(value);
+#else
+    int index = 0;
+    while (!(value & 1)) {
+        value >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+const size_t kStreamChunkBytes = 1 << 20;  // read buffer for streamFromFile
+
+// exp(-0.1 * rank) underflows to exactly zero from rank 7452 on, so lower
+// ranks add nothing to the confidence weights
+const size_t kRankWeightHorizon = 7500;
+
+}  // namespace
+
+// Checks shared by the add methods; numQuestions is 0 while nothing is stored
+void AnswerAnalyzer::validateAttempt(const std::vector<std::string>& answers, double percentage,
+                                     size_t numQuestions) const {
     if (percentage < 0.0 || percentage > 100.0) {
         throw AnswerAnalyzerException("Percentage must be between 0 and 100");
     }
@@ -15,216 +61,750 @@ void AnswerAnalyzer::addAttempt(const std::vector<std::string>& answers, double
         throw AnswerAnalyzerException("Invalid number of answers");
     }
     
-    if (!attempts.empty() && answers.size() != attempts[0].answers.size()) {
+    if (numQuestions != 0 && answers.size() != numQuestions) {
         throw AnswerAnalyzerException("Number of answers must match previous attempts");
     }
+}
+
+void AnswerAnalyzer::addAttempt(const std::vector<std::string>& answers, double percentage) {
+    ANALYZER_PROFILE("AnswerAnalyzer::addAttempt(const&)");
+    if (fuzzyMatching) {
+        // Clustering rewrites the answers, so work on a copy
+        addAttempt(std::vector<std::string>(answers), percentage);
+        return;
+    }
+    validateAttempt(answers, percentage, attempts.empty() ? 0 : attempts.numQuestions());
+    
+    try {
+        attempts.add(answers, percentage);
+    } catch (const AttemptStoreException& e) {
+        throw AnswerAnalyzerException(e.what());
+    }
+    updateSummaries(percentage);
+    combinationsCalculated = false;
+    confidencesCalculated = false;
+    if (journal) {
+        journalAttempts(attempts.size() - 1);
+    }
+}
+
+void AnswerAnalyzer::addAttempt(std::vector<std::string>&& answers, double percentage) {
+    ANALYZER_PROFILE("AnswerAnalyzer::addAttempt(&&)");
+    validateAttempt(answers, percentage, attempts.empty() ? 0 : attempts.numQuestions());
+    if (fuzzyMatching) {
+        clusterAnswers(answers);
+    }
+    
+    try {
+        attempts.add(std::move(answers), percentage);
+    } catch (const AttemptStoreException& e) {
+        if (fuzzyMatching) {
+            unclusterAnswers();
+        }
+        throw AnswerAnalyzerException(e.what());
+    }
+    updateSummaries(percentage);
+    combinationsCalculated = false;
+    confidencesCalculated = false;
+    if (journal) {
+        journalAttempts(attempts.size() - 1);
+    }
+}
+
+void AnswerAnalyzer::addAttempts(std::vector<TestAttempt>&& batch) {
+    ANALYZER_PROFILE("AnswerAnalyzer::addAttempts");
+    if (batch.empty()) {
+        return;
+    }
     
-    attempts.emplace_back(answers, percentage);
+    size_t numQuestions = attempts.empty() ? batch.front().answers.size() : attempts.numQuestions();
+    for (size_t i = 0; i < batch.size(); ++i) {
+        try {
+            validateAttempt(batch[i].answers, batch[i].percentage, numQuestions);
+        } catch (const AnswerAnalyzerException& e) {
+            throw AnswerAnalyzerException("Attempt " + std::to_string(i + 1) + " of the batch: " +
+                                          e.what());
+        }
+    }
+    // A batch at least as large as the history is cheaper to index with one
+    // sort afterwards than with an insert per record
+    const bool reindex = batch.size() >= attempts.size();
+    
+    // Only the per-question limit on distinct answers is left to the store;
+    // records before one that trips it stay added. Each record is clustered
+    // just before it is added, so only the failing one's clusters need
+    // dropping.
+    const size_t firstAdded = attempts.size();
+    try {
+        size_t next = 0;
+        if (attempts.empty()) {
+            if (fuzzyMatching) {
+                clusterAnswers(batch[0].answers);
+            }
+            attempts.add(std::move(batch[0].answers), batch[0].percentage);
+            updateSummaries(batch[0].percentage, !reindex);
+            next = 1;
+        }
+        attempts.reserve(attempts.size() + batch.size() - next);
+        for (size_t i = next; i < batch.size(); ++i) {
+            if (fuzzyMatching) {
+                clusterAnswers(batch[i].answers);
+            }
+            attempts.add(std::move(batch[i].answers), batch[i].percentage);
+            updateSummaries(batch[i].percentage, !reindex);
+        }
+    } catch (const AttemptStoreException& e) {
+        if (fuzzyMatching) {
+            unclusterAnswers();
+        }
+        if (reindex && attempts.retainsAttempts()) {
+            rebuildScoreIndex();
+        }
+        combinationsCalculated = false;
+        confidencesCalculated = false;
+        if (journal) {
+            journalAttempts(firstAdded);
+        }
+        throw AnswerAnalyzerException(e.what());
+    }
+    if (reindex && attempts.retainsAttempts()) {
+        rebuildScoreIndex();
+    }
     combinationsCalculated = false;
+    confidencesCalculated = false;
+    if (journal) {
+        journalAttempts(firstAdded);
+    }
+}
+
+// Fold the attempt just added to the store into the running summaries.
+// Without indexAttempt the score index and patterns are left for the caller
+// to rebuild.
+void AnswerAnalyzer::updateSummaries(double percentage, bool indexAttempt) {
+    const size_t attemptIndex = attempts.size() - 1;
+    const auto& ids = attempts.latestAnswerIds();
+    
+    answerStats.resize(attempts.numQuestions());
+    for (size_t q = 0; q < attempts.numQuestions(); ++q) {
+        // Ids are handed out densely, so a new answer is always the next slot
+        answerStats[q].resize(attempts.numAnswers(q));
+        AnswerStats& stats = answerStats[q][ids[q]];
+        stats.count++;
+        if (percentage < 20.0) {
+            stats.lowScoreCount++;
+        }
+        double answerDelta = percentage - stats.scoreMean;
+        stats.scoreMean += answerDelta / stats.count;
+        stats.scoreM2 += answerDelta * (percentage - stats.scoreMean);
+    }
+    
+    // Welford's online mean and variance
+    double delta = percentage - scoreMean;
+    scoreMean += delta / attempts.size();
+    scoreM2 += delta * (percentage - scoreMean);
+    
+    // The score index and patterns refer to stored attempts
+    if (!attempts.retainsAttempts() || !indexAttempt) {
+        return;
+    }
+    
+    scoreIndex.insert(attemptIndex, percentage);
+    
+    patternAttempts[static_cast<size_t>(std::round(percentage))] = attemptIndex;
+}
+
+// Recompute every summary from the stored attempts in one pass; gives the
+// same result as folding the attempts in one by one with updateSummaries
+void AnswerAnalyzer::rebuildSummaries() {
+    const size_t numAttempts = attempts.size();
+    
+    answerStats.assign(attempts.numQuestions(), {});
+    for (size_t q = 0; q < attempts.numQuestions(); ++q) {
+        answerStats[q].resize(attempts.numAnswers(q));
+        const AttemptStore::AnswerId* ids = attempts.column(q);
+        for (size_t i = 0; i < numAttempts; ++i) {
+            const double percentage = attempts.percentage(i);
+            AnswerStats& stats = answerStats[q][ids[i]];
+            stats.count++;
+            if (percentage < 20.0) {
+                stats.lowScoreCount++;
+            }
+            double answerDelta = percentage - stats.scoreMean;
+            stats.scoreMean += answerDelta / stats.count;
+            stats.scoreM2 += answerDelta * (percentage - stats.scoreMean);
+        }
+    }
+    
+    scoreMean = 0.0;
+    scoreM2 = 0.0;
+    for (size_t i = 0; i < numAttempts; ++i) {
+        const double percentage = attempts.percentage(i);
+        double delta = percentage - scoreMean;
+        scoreMean += delta / (i + 1);
+        scoreM2 += delta * (percentage - scoreMean);
+    }
+    
+    combinationsCalculated = false;
+    confidencesCalculated = false;
+}
+
+// Rebuild the per-attempt indexes: scores in rank order and the latest
+// attempt for each rounded score
+void AnswerAnalyzer::rebuildScoreIndex() {
+    const size_t numAttempts = attempts.size();
+    
+    patternAttempts.clear();
+    for (size_t i = 0; i < numAttempts; ++i) {
+        patternAttempts[static_cast<size_t>(std::round(attempts.percentage(i)))] = i;
+    }
+    
+    std::vector<double> percentages(numAttempts);
+    for (size_t i = 0; i < numAttempts; ++i) {
+        percentages[i] = attempts.percentage(i);
+    }
+    scoreIndex.assign(percentages.data(), numAttempts);
+}
+
+// Queries that look at individual attempts have nothing to work with after
+// streamFromFile
+void AnswerAnalyzer::requireAttempts(const char* operation) const {
+    if (!attempts.retainsAttempts()) {
+        throw AnswerAnalyzerException(std::string(operation) +
+                                      " needs the attempts, but only a summary was loaded");
+    }
+}
+
+void AnswerAnalyzer::requireJournal(const char* operation) const {
+    if (!journal) {
+        throw AnswerAnalyzerException(std::string(operation) + " needs an open journal");
+    }
+}
+
+// Journal the attempts from first on, compacting once the journal is long
+void AnswerAnalyzer::journalAttempts(size_t first) {
+    try {
+        for (size_t i = first; i < attempts.size(); ++i) {
+            journal->append(attempts, i);
+        }
+    } catch (const AttemptJournalException& e) {
+        throw AnswerAnalyzerException(e.what());
+    }
+    if (journal->needsCompaction()) {
+        compactJournal();
+    }
 }
 
 void AnswerAnalyzer::analyzeResults() const {
+    ANALYZER_PROFILE("AnswerAnalyzer::analyzeResults");
     if (attempts.empty()) {
         throw AnswerAnalyzerException("No attempts to analyze");
     }
     
-    // Basic analysis is performed by other methods when needed
-    // This method could be expanded to perform more complex analysis
+    // Statistics are maintained incrementally; only the definite answers
+    // need solving
+    if (!combinationsCalculated) {
+        updateDefiniteAnswers();
+    }
 }
 
 void AnswerAnalyzer::clear() {
+    ANALYZER_PROFILE("AnswerAnalyzer::clear");
     attempts.clear();
     possibleCombinations.clear();
     combinationsCalculated = false;
+    modelCount.reset();
+    answerStats.clear();
+    scoreMean = 0.0;
+    scoreM2 = 0.0;
+    scoreIndex.clear();
+    patternAttempts.clear();
+    cachedConfidences.clear();
+    confidencesCalculated = false;
+    if (scorer) {
+        scorer->reset();
+    }
+    answerIndexes.clear();
     definiteAnswers.clear();
     definiteAnswers.resize(maxAnswers);
+    if (journal) {
+        compactJournal();
+    }
+}
+
+void AnswerAnalyzer::setScorer(std::shared_ptr<AnswerScorer> answerScorer) {
+    ANALYZER_PROFILE("AnswerAnalyzer::setScorer");
+    scorer = std::move(answerScorer);
+    if (scorer) {
+        scorer->reset();
+    }
+    confidencesCalculated = false;
+}
+
+void AnswerAnalyzer::setFuzzyMatching(std::optional<FuzzyMatchOptions> options) {
+    ANALYZER_PROFILE("AnswerAnalyzer::setFuzzyMatching");
+    if (!attempts.empty()) {
+        throw AnswerAnalyzerException("Fuzzy matching must be chosen before adding attempts");
+    }
+    fuzzyMatching = options;
+    answerIndexes.clear();
+}
+
+// Replace every answer by its cluster's spelling; the attempt has already
+// been validated
+void AnswerAnalyzer::clusterAnswers(std::vector<std::string>& answers) {
+    if (answerIndexes.size() != answers.size()) {
+        answerIndexes.assign(answers.size(), FuzzyAnswerIndex(*fuzzyMatching));
+    }
+    clusterCounts.resize(answers.size());
+    for (size_t q = 0; q < answers.size(); ++q) {
+        clusterCounts[q] = answerIndexes[q].size();
+        answers[q] = answerIndexes[q].canonical(answers[q]);
+    }
+}
+
+// Drop the clusters opened by the last clusterAnswers, whose attempt the
+// store then rejected
+void AnswerAnalyzer::unclusterAnswers() {
+    for (size_t q = 0; q < clusterCounts.size() && q < answerIndexes.size(); ++q) {
+        answerIndexes[q].truncate(clusterCounts[q]);
+    }
+}
+
+void AnswerAnalyzer::setDeductionBackend(DeductionBackend backend) {
+    ANALYZER_PROFILE("AnswerAnalyzer::setDeductionBackend");
+    if (backend != deductionBackend) {
+        deductionBackend = backend;
+        combinationsCalculated = false;
+    }
+}
+
+TestAttempt AnswerAnalyzer::getAttempt(size_t index) const {
+    ANALYZER_PROFILE("AnswerAnalyzer::getAttempt");
+    requireAttempts("Reading an attempt");
+    if (index >= attempts.size()) {
+        throw AnswerAnalyzerException("Attempt index out of range");
+    }
+    return TestAttempt(attempts.answers(index), attempts.percentage(index));
+}
+
+void AnswerAnalyzer::setThreadCount(size_t threads) {
+    ANALYZER_PROFILE("AnswerAnalyzer::setThreadCount");
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (threads == getThreadCount()) {
+        return;
+    }
+    threadPool = threads > 1 ? std::make_shared<ThreadPool>(threads) : nullptr;
+}
+
+size_t AnswerAnalyzer::getThreadCount() const {
+    return threadPool ? threadPool->size() : 1;
+}
+
+// Run body over [0, count) on the pool, or inline when running serially.
+// Every index must write only its own outputs so the result is independent
+// of scheduling.
+void AnswerAnalyzer::forEachIndex(size_t count, size_t grain,
+                                  const std::function<void(size_t, size_t)>& body) const {
+    if (threadPool) {
+        threadPool->parallelFor(count, grain, body);
+    } else if (count > 0) {
+        body(0, count);
+    }
 }
 
 std::vector<std::string> AnswerAnalyzer::getMostCommonAnswers() const {
+    ANALYZER_PROFILE("AnswerAnalyzer::getMostCommonAnswers");
     if (attempts.empty()) {
         return {};
     }
     
-    std::vector<std::string> result;
-    size_t numQuestions = attempts[0].answers.size();
+    std::vector<std::string> result(answerStats.size());
     
-    for (size_t q = 0; q < numQuestions; ++q) {
-        std::map<std::string, int> answerCounts;
-        for (const auto& attempt : attempts) {
-            answerCounts[attempt.answers[q]]++;
+    forEachIndex(answerStats.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t q = begin; q < end; ++q) {
+            // Walk the dictionary so ties go to the alphabetically first answer
+            const auto& questionStats = answerStats[q];
+            const auto& dictionary = attempts.dictionary(q);
+            auto maxElement = std::max_element(
+                dictionary.begin(), 
+                dictionary.end(),
+                [&questionStats](const auto& p1, const auto& p2) {
+                    return questionStats[p1.second].count < questionStats[p2.second].count;
+                }
+            );
+            
+            result[q] = maxElement->first;
         }
-        
-        auto maxElement = std::max_element(
-            answerCounts.begin(), 
-            answerCounts.end(),
-            [](const auto& p1, const auto& p2) {
-                return p1.second < p2.second;
-            }
-        );
-        
-        result.push_back(maxElement->first);
-    }
+    });
     
     return result;
 }
 
 std::vector<std::pair<std::string, double>> AnswerAnalyzer::getAnswerConfidences() const {
+    std::vector<std::pair<std::string, double>> result;
+    getAnswerConfidences(result);
+    return result;
+}
+
+void AnswerAnalyzer::getAnswerConfidences(std::vector<std::pair<std::string, double>>& out) const {
+    ANALYZER_PROFILE("AnswerAnalyzer::getAnswerConfidences");
+    out = confidences();
+}
+
+const std::vector<std::pair<std::string, double>>& AnswerAnalyzer::confidences() const {
+    if (confidencesCalculated) {
+        return cachedConfidences;
+    }
+    
+    requireAttempts("Answer confidence");
+    std::vector<std::pair<std::string, double>>& result = cachedConfidences;
     if (attempts.empty()) {
-        return {};
+        result.clear();
+        confidencesCalculated = true;
+        return result;
     }
     
-    std::vector<std::pair<std::string, double>> result;
-    size_t numQuestions = attempts[0].answers.size();
+    if (scorer) {
+        scorer->score(attempts, result);
+        confidencesCalculated = true;
+        return result;
+    }
+    
+    size_t numQuestions = attempts.numQuestions();
+    size_t highScoreTotal = scoreIndex.size() / 2 + 1;
+    ConfidenceScratch& scratch = confidenceScratch;
     
-    // Sort attempts by score to give more weight to higher-scoring attempts
-    std::vector<const TestAttempt*> sortedAttempts;
-    for (const auto& attempt : attempts) {
-        sortedAttempts.push_back(&attempt);
+    // Only the top ranks matter: those with a nonzero weight and those
+    // counted as high-scoring
+    const size_t ranks = std::min(scoreIndex.size(), std::max(highScoreTotal, kRankWeightHorizon));
+    scoreIndex.topK(ranks, scratch.rankOrder);
+    
+    // Give more weight to higher-scoring attempts and severely penalize
+    // answers that resulted in very low scores. The weight depends only on
+    // the rank, so it is shared by every question and filled in attempt
+    // chunks, which keeps all cores busy when there are few questions.
+    // The bodies are passed by reference so std::function need not copy them.
+    std::vector<double>& rankDecay = scratch.rankDecay;
+    for (size_t i = rankDecay.size(); i < ranks; ++i) {
+        rankDecay.push_back(std::exp(-0.1 * i));
     }
-    std::sort(sortedAttempts.begin(), sortedAttempts.end(),
-              [](const TestAttempt *a, const TestAttempt *b) {
-                return a->percentage > b->percentage;
-              });
+    std::vector<double>& rankWeights = scratch.rankWeights;
+    std::vector<double>& rankScores = scratch.rankScores;
+    rankWeights.resize(ranks);
+    rankScores.resize(ranks);
+    auto weighRanks = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            rankScores[i] = attempts.percentage(scratch.rankOrder[i]);
+            double scoreWeight = rankScores[i] < 20.0 ? -0.5 : 1.0;
+            rankWeights[i] = rankDecay[i] * scoreWeight;
+        }
+    };
+    forEachIndex(ranks, 4096, std::cref(weighRanks));
     
+    // One flat tally per question and answer, each question in its own slice
+    scratch.offsets.resize(numQuestions + 1);
+    size_t tallies = 0;
     for (size_t q = 0; q < numQuestions; ++q) {
-        std::map<std::string, std::vector<double>> answerScores;
-        std::map<std::string, double> weightedScores;
-        std::map<std::string, double> totalWeights;
-        
-        // First, collect all scores for each answer
-        for (const auto& attempt : attempts) {
-            answerScores[attempt.answers[q]].push_back(attempt.percentage);
+        scratch.offsets[q] = tallies;
+        tallies += attempts.numAnswers(q);
+    }
+    scratch.offsets[numQuestions] = tallies;
+    scratch.weightedScores.assign(tallies, 0.0);
+    scratch.totalWeights.assign(tallies, 0.0);
+    scratch.highScoreSuccesses.assign(tallies, 0);
+    
+    // Resizing rather than reassigning keeps each answer string's buffer
+    result.resize(numQuestions);
+    auto scoreQuestions = [&](size_t begin, size_t end) {
+        for (size_t q = begin; q < end; ++q) {
+            auto [answer, confidence] = questionConfidence(q, highScoreTotal);
+            if (answer) {
+                result[q].first = *answer;
+            } else {
+                result[q].first.clear();
+            }
+            result[q].second = confidence;
         }
+    };
+    forEachIndex(numQuestions, 1, std::cref(scoreQuestions));
+    
+    confidencesCalculated = true;
+    return result;
+}
+
+// Best answer and its confidence for one question, from the rank weights
+// in the scratch buffers; tallies into the question's own slice of them
+std::pair<const std::string*, double> AnswerAnalyzer::questionConfidence(
+    size_t q, size_t highScoreTotal) const {
+    const AttemptStore::AnswerId* column = attempts.column(q);
+    const std::vector<double>& rankWeights = confidenceScratch.rankWeights;
+    const std::vector<double>& rankScores = confidenceScratch.rankScores;
+    double* weightedScores = confidenceScratch.weightedScores.data() + confidenceScratch.offsets[q];
+    double* totalWeights = confidenceScratch.totalWeights.data() + confidenceScratch.offsets[q];
+    std::uint32_t* highScoreSuccesses =
+        confidenceScratch.highScoreSuccesses.data() + confidenceScratch.offsets[q];
+    
+    const std::vector<size_t>& rankOrder = confidenceScratch.rankOrder;
+    for (size_t i = 0; i < rankOrder.size(); ++i) {
+        double percentage = rankScores[i];
+        AttemptStore::AnswerId answer = column[rankOrder[i]];
+        double weight = rankWeights[i];
         
-        // Calculate weighted scores with penalty for low scores
-        for (size_t i = 0; i < sortedAttempts.size(); ++i) {
-            const auto& attempt = *sortedAttempts[i];
-            const std::string& answer = attempt.answers[q];
-            
-            // Severely penalize answers that resulted in very low scores
-            double scoreWeight = attempt.percentage < 20.0 ? -0.5 : 1.0;
-            double weight = std::exp(-0.1 * i) * scoreWeight;
-            
-            weightedScores[answer] += attempt.percentage * weight;
-            totalWeights[answer] += std::abs(weight); // Use absolute value for total
+        weightedScores[answer] += percentage * weight;
+        totalWeights[answer] += std::abs(weight); // Use absolute value for total
+        
+        // Count successes in high-scoring attempts (top 50%)
+        if (i < highScoreTotal && percentage >= 40.0) {
+            highScoreSuccesses[answer]++;
+        }
+    }
+    
+    // Find best answer considering penalties, in alphabetical order
+    const std::string* bestAnswer = nullptr;
+    double bestConfidence = -1.0;
+    
+    for (const auto& [answer, id] : attempts.dictionary(q)) {
+        const AnswerStats& stats = answerStats[q][id];
+        // Skip answers that only appeared in very low scoring attempts
+        if (stats.lowScoreCount == stats.count) {
+            continue;
         }
         
-        // Find best answer considering penalties
-        std::string bestAnswer;
-        double bestConfidence = -1.0;
+        // Calculate weighted average score
+        double avgScore = weightedScores[id] / totalWeights[id];
         
-        for (const auto& [answer, scores] : answerScores) {
-            // Skip answers that only appeared in very low scoring attempts
-            if (std::all_of(scores.begin(), scores.end(), 
-                           [](double score) { return score < 20.0; })) {
-                continue;
-            }
-            
-            // Calculate weighted average score
-            double avgScore = weightedScores[answer] / totalWeights[answer];
-            
-            // Calculate score consistency
-            double variance = 0.0;
-            for (double score : scores) {
-                variance += (score - avgScore) * (score - avgScore);
-            }
-            variance = scores.size() > 1 ? variance / (scores.size() - 1) : 0.0;
-            
-            // Calculate success rate in high-scoring attempts (top 50%)
-            int highScoreSuccesses = 0;
-            int highScoreTotal = 0;
-            for (size_t i = 0; i < sortedAttempts.size() / 2 + 1; ++i) {
-                if (sortedAttempts[i]->answers[q] == answer) {
-                    if (sortedAttempts[i]->percentage >= 40.0) {
-                        highScoreSuccesses++;
-                    }
-                }
-                highScoreTotal++;
-            }
-            double highScoreRate = static_cast<double>(highScoreSuccesses) / highScoreTotal;
-            
-            // Combined confidence metric with stronger penalty for low scores
-            double confidence = avgScore * 0.3 + highScoreRate * 100 * 0.7;
-            confidence /= (1.0 + std::sqrt(variance) * 0.2);
-            
-            // Additional penalty for answers that appeared in very low scoring attempts
-            for (double score : scores) {
-                if (score < 20.0) {
-                    confidence *= 0.5; // Reduce confidence by half for each very low score
-                }
-            }
-            
-            if (confidence > bestConfidence) {
-                bestConfidence = confidence;
-                bestAnswer = answer;
-            }
-        }
+        // Calculate score consistency around the weighted average from the
+        // running moments: sum((s - avg)^2) = M2 + n * (mean - avg)^2
+        double meanShift = stats.scoreMean - avgScore;
+        double variance = stats.scoreM2 + stats.count * meanShift * meanShift;
+        variance = stats.count > 1 ? variance / (stats.count - 1) : 0.0;
+        
+        double highScoreRate = static_cast<double>(highScoreSuccesses[id]) / highScoreTotal;
+        
+        // Combined confidence metric with stronger penalty for low scores
+        double confidence = avgScore * 0.3 + highScoreRate * 100 * 0.7;
+        confidence /= (1.0 + std::sqrt(variance) * 0.2);
         
-        // Normalize confidence and ensure very low scoring answers get very low confidence
-        double normalizedConfidence = std::max(0.0, std::min(100.0, bestConfidence));
-        result.emplace_back(bestAnswer, normalizedConfidence);
+        // Reduce confidence by half for each very low score
+        confidence *= std::pow(0.5, static_cast<double>(stats.lowScoreCount));
+        
+        if (confidence > bestConfidence) {
+            bestConfidence = confidence;
+            bestAnswer = &answer;
+        }
     }
     
-    return result;
+    // Normalize confidence and ensure very low scoring answers get very low confidence
+    double normalizedConfidence = std::max(0.0, std::min(100.0, bestConfidence));
+    return {bestAnswer, normalizedConfidence};
 }
 
 std::map<size_t, std::vector<std::string>> AnswerAnalyzer::getAnswerPatterns() const {
+    ANALYZER_PROFILE("AnswerAnalyzer::getAnswerPatterns");
+    requireAttempts("Answer patterns");
     std::map<size_t, std::vector<std::string>> patterns;
     
-    for (const auto& attempt : attempts) {
-        size_t scoreKey = static_cast<size_t>(std::round(attempt.percentage));
-        patterns[scoreKey] = attempt.answers;
+    for (const auto& [scoreKey, attemptIndex] : patternAttempts) {
+        patterns.emplace_hint(patterns.end(), scoreKey, attempts.answers(attemptIndex));
     }
     
     return patterns;
 }
 
 std::vector<std::string> AnswerAnalyzer::suggestNextAttempt() const {
-    auto confidences = getAnswerConfidences();
-    std::vector<std::string> suggestion;
+    return suggestNextAttempt(SuggestionOptions());
+}
+
+// Search for the sheet that best serves the objective against a sample of
+// answer keys, starting from the top-confidence answers. A sheet may use any
+// non-blank answer recorded for a question, or try a new one: the first
+// answer given anywhere else on the test that was never given to it.
+std::vector<std::string> AnswerAnalyzer::suggestNextAttempt(const SuggestionOptions& options) const {
+    ANALYZER_PROFILE("AnswerAnalyzer::suggestNextAttempt");
+    requireAttempts("Suggesting an attempt");
+    if (attempts.empty()) {
+        return {};
+    }
     
-    for (const auto& [answer, confidence] : confidences) {
-        suggestion.push_back(answer);
+    const size_t numQuestions = attempts.numQuestions();
+    std::set<std::string> alphabet;
+    for (size_t q = 0; q < numQuestions; ++q) {
+        for (const auto& [answer, id] : attempts.dictionary(q)) {
+            if (!answer.empty()) {
+                alphabet.insert(answer);
+            }
+        }
+    }
+    
+    const auto& conf = confidences();
+    std::vector<std::vector<AttemptStore::AnswerId>> choices(numQuestions);
+    std::vector<AttemptStore::AnswerId> start(numQuestions);
+    std::vector<std::string> newAnswers(numQuestions);
+    for (size_t q = 0; q < numQuestions; ++q) {
+        for (const auto& [answer, id] : attempts.dictionary(q)) {
+            if (!answer.empty()) {
+                choices[q].push_back(id);
+            }
+        }
+        
+        // Id numAnswers(q) is the untried answer in the sampled keys too
+        for (const auto& answer : alphabet) {
+            if (attempts.findAnswer(q, answer) == AttemptStore::kNoAnswer) {
+                newAnswers[q] = answer;
+                choices[q].push_back(static_cast<AttemptStore::AnswerId>(attempts.numAnswers(q)));
+                break;
+            }
+        }
+        if (choices[q].empty()) {
+            choices[q].push_back(0);  // only blanks so far
+        }
+        
+        AttemptStore::AnswerId best = attempts.findAnswer(q, conf[q].first);
+        bool usable = std::find(choices[q].begin(), choices[q].end(), best) != choices[q].end();
+        start[q] = usable ? best : choices[q].front();
     }
     
+    SuggestionSearch search(sampleAnswerKeys(options), choices);
+    std::vector<AttemptStore::AnswerId> sheet = search.search(start, options);
+    
+    std::vector<std::string> suggestion;
+    suggestion.reserve(numQuestions);
+    for (size_t q = 0; q < numQuestions; ++q) {
+        suggestion.push_back(sheet[q] < attempts.numAnswers(q) ? attempts.answerText(q, sheet[q])
+                                                               : newAnswers[q]);
+    }
     return suggestion;
 }
 
+// Plausible answer keys as answer ids; an id past the dictionary stands for
+// an answer nobody has tried. If the deduction engine can list every key
+// consistent with the attempts, those are used; otherwise whatever
+// consistent keys it can sample. Only when it finds none (inconsistent
+// scores, or too hard within budget) are keys drawn per question from the
+// confidences instead.
+std::vector<std::vector<AttemptStore::AnswerId>> AnswerAnalyzer::sampleAnswerKeys(
+    const SuggestionOptions& options) const {
+    const size_t numQuestions = attempts.numQuestions();
+    std::vector<std::vector<AttemptStore::AnswerId>> keys;
+    
+    if (numQuestions > 0 && numQuestions <= 1000) {
+        DeductionEngine engine = buildDeductionEngine();
+        std::vector<std::vector<std::uint32_t>> models;
+        if (!engine.enumerateModels(options.sampleKeys, models)) {
+            models = engine.sampleModels(options.sampleKeys, options.seed);
+        }
+        if (!models.empty()) {
+            for (const auto& model : models) {
+                keys.emplace_back(model.begin(), model.end());
+            }
+            return keys;
+        }
+    }
+    
+    // Independent per-question draws: the top-confidence answer gets its
+    // confidence as probability, the rest is shared by the other answers
+    // and an untried one. Settled answers of the latest attempt are honoured.
+    const auto& conf = confidences();
+    const auto& definite = getDefiniteAnswers();
+    std::vector<std::discrete_distribution<int>> perQuestion;
+    for (size_t q = 0; q < numQuestions; ++q) {
+        size_t numOptions = attempts.numAnswers(q) + 1;
+        AttemptStore::AnswerId best = attempts.findAnswer(q, conf[q].first);
+        AttemptStore::AnswerId latest = attempts.answerId(q, attempts.size() - 1);
+        
+        std::vector<double> weights(numOptions, 0.0);
+        double bestProbability = std::min(0.99, std::max(1.0 / numOptions, conf[q].second / 100.0));
+        for (size_t o = 0; o < numOptions; ++o) {
+            weights[o] = best == AttemptStore::kNoAnswer ? 1.0 / numOptions
+                       : o == best ? bestProbability
+                       : (1.0 - bestProbability) / (numOptions - 1);
+        }
+        if (q < definite.size() && definite[q].has_value()) {
+            if (*definite[q]) {
+                std::fill(weights.begin(), weights.end(), 0.0);
+                weights[latest] = 1.0;
+            } else if (numOptions > 1) {
+                weights[latest] = 0.0;
+            }
+        }
+        perQuestion.emplace_back(weights.begin(), weights.end());
+    }
+    
+    std::mt19937 random(options.seed);
+    keys.assign(options.sampleKeys, std::vector<AttemptStore::AnswerId>(numQuestions));
+    for (auto& key : keys) {
+        for (size_t q = 0; q < numQuestions; ++q) {
+            key[q] = static_cast<AttemptStore::AnswerId>(perQuestion[q](random));
+        }
+    }
+    return keys;
+}
+
 
 double AnswerAnalyzer::predictScore(const std::vector<std::string>& answers) const {
+    ANALYZER_PROFILE("AnswerAnalyzer::predictScore");
     if (attempts.empty() || answers.empty()) {
         return 0.0;
     }
     
-    // Sort attempts by score
-    std::vector<const TestAttempt*> sortedAttempts;
-    for (const auto& attempt : attempts) {
-        sortedAttempts.push_back(&attempt);
+    return predictScoreWithWeights(answers, questionWeights());
+}
+
+std::vector<double> AnswerAnalyzer::predictScores(
+    const std::vector<std::vector<std::string>>& candidates) const {
+    ANALYZER_PROFILE("AnswerAnalyzer::predictScores");
+    std::vector<double> result(candidates.size(), 0.0);
+    if (attempts.empty()) {
+        return result;
     }
-    std::sort(sortedAttempts.begin(), sortedAttempts.end(),
-        [](const TestAttempt* a, const TestAttempt* b) {
-            return a->percentage > b->percentage;
-        });
     
-    // Calculate similarity scores with emphasis on matching high-scoring patterns
-    std::vector<double> similarityScores;
-    for (const auto& attempt : attempts) {
-        double matchingScore = 0.0;
-        double totalWeight = 0.0;
-        
-        for (size_t i = 0; i < answers.size() && i < attempt.answers.size(); ++i) {
-            // Weight each question based on its confidence
-            double confidence = getAnswerConfidences()[i].second / 100.0;
-            double weight = 1.0 + confidence; // Questions with higher confidence count more
-            
-            if (answers[i] == attempt.answers[i]) {
-                matchingScore += weight;
+    // The question weights are shared by every candidate
+    std::vector<double> weights = questionWeights();
+    forEachIndex(candidates.size(), 8, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            if (!candidates[c].empty()) {
+                result[c] = predictScoreWithWeights(candidates[c], weights);
             }
-            totalWeight += weight;
         }
+    });
+    
+    return result;
+}
+
+// Weight each question based on its confidence: questions with higher
+// confidence count more when comparing answer sheets
+std::vector<double> AnswerAnalyzer::questionWeights() const {
+    const auto& conf = confidences();
+    std::vector<double> weights;
+    weights.reserve(conf.size());
+    for (const auto& [answer, confidence] : conf) {
+        weights.push_back(1.0 + confidence / 100.0);
+    }
+    return weights;
+}
+
+double AnswerAnalyzer::predictScoreWithWeights(const std::vector<std::string>& answers,
+                                               const std::vector<double>& weights) const {
+    // Calculate similarity scores with emphasis on matching high-scoring
+    // patterns. The candidate is interned once, then each question is a scan
+    // of its column; an answer nobody gave never matches.
+    size_t numQuestions = std::min(answers.size(), attempts.numQuestions());
+    std::vector<double> similarityScores(attempts.size(), 0.0);
+    double questionWeightTotal = 0.0;
+    for (size_t q = 0; q < numQuestions; ++q) {
+        questionWeightTotal += weights[q];
         
-        double similarity = totalWeight > 0.0 ? matchingScore / totalWeight : 0.0;
-        similarityScores.push_back(similarity);
+        AttemptStore::AnswerId id = attempts.findAnswer(q, answers[q]);
+        if (id == AttemptStore::kNoAnswer) {
+            continue;
+        }
+        accumulateMatchWeights(attempts.column(q), attempts.size(), id, weights[q],
+                               similarityScores.data());
+    }
+    for (double& similarity : similarityScores) {
+        similarity = questionWeightTotal > 0.0 ? similarity / questionWeightTotal : 0.0;
     }
     
     // Predict score using weighted average of similar attempts
@@ -233,10 +813,11 @@ double AnswerAnalyzer::predictScore(const std::vector<std::string>& answers) con
     
     for (size_t i = 0; i < attempts.size(); ++i) {
         // Weight calculation considers both similarity and the attempt's score
+        double percentage = attempts.percentage(i);
         double weight = similarityScores[i] * similarityScores[i] * 
-                       (1.0 + attempts[i].percentage / 100.0); // Boost weight for high-scoring attempts
+                       (1.0 + percentage / 100.0); // Boost weight for high-scoring attempts
         totalWeight += weight;
-        weightedSum += weight * attempts[i].percentage;
+        weightedSum += weight * percentage;
     }
     
     return totalWeight > 0.0 ? weightedSum / totalWeight : 0.0;
@@ -244,55 +825,809 @@ double AnswerAnalyzer::predictScore(const std::vector<std::string>& answers) con
 
 
 double AnswerAnalyzer::getAverageScore() const {
-    if (attempts.empty()) {
-        return 0.0;
+    ANALYZER_PROFILE("AnswerAnalyzer::getAverageScore");
+    return attempts.empty() ? 0.0 : scoreMean;
+}
+
+double AnswerAnalyzer::getScoreVariance() const {
+    ANALYZER_PROFILE("AnswerAnalyzer::getScoreVariance");
+    return attempts.empty() ? 0.0 : scoreM2 / attempts.size();
+}
+
+// Number of correct answers implied by an attempt's percentage
+size_t AnswerAnalyzer::expectedCorrect(size_t attemptIndex) const {
+    return static_cast<size_t>(std::lround(attempts.percentage(attemptIndex) *
+                                           attempts.numQuestions() / 100.0));
+}
+
+bool AnswerAnalyzer::isValidCombination(const std::vector<std::uint64_t>& correctMasks) const {
+    if (correctMasks.size() != attempts.size()) {
+        return false;
     }
     
-    double sum = std::accumulate(attempts.begin(), attempts.end(), 0.0,
-        [](double acc, const TestAttempt& attempt) {
-            return acc + attempt.percentage;
-        });
+    for (size_t i = 0; i < correctMasks.size(); ++i) {
+        if (static_cast<size_t>(popcount64(correctMasks[i])) != expectedCorrect(i)) {
+            return false;
+        }
+    }
     
-    return sum / attempts.size();
+    return true;
 }
 
-double AnswerAnalyzer::getScoreVariance() const {
-    if (attempts.empty()) {
-        return 0.0;
+namespace {
+
+// Search state: the answers still allowed for each question, and for each
+// attempt the questions already known to be correct or incorrect
+struct KeyState {
+    std::vector<std::uint64_t> domains;        // bit o = option o still possible
+    std::vector<std::uint64_t> correctMasks;   // bit q = answer to q is correct
+    std::vector<std::uint64_t> incorrectMasks; // bit q = answer to q is incorrect
+};
+
+// Two attempts that differ on only a few questions: the difference of their
+// correct counts is decided by those questions alone
+struct PairConstraint {
+    size_t first;
+    size_t second;
+    std::uint64_t differing;  // questions where the two answers differ
+    long difference;          // targets[first] - targets[second]
+};
+
+// Backtracking search over candidate answer keys. Each question takes one of
+// the answers already tried for it or one nobody has tried yet (the last
+// option). Every attempt's correctness vector is kept as a pair of 64-bit
+// masks, and popcounts against the attempt's expected number of correct
+// answers prune partial keys and force the remaining questions: an attempt
+// that already has all its correct answers must be wrong everywhere else, and
+// one that needs every undecided question must be right on all of them.
+// Pairs of similar attempts add the same reasoning over the questions where
+// they differ.
+class KeySearch {
+public:
+    // optionOf[q][i] = option attempt i chose for question q
+    std::vector<std::vector<size_t>> optionOf;
+    // matchingAttempts[q][o] = attempts that chose option o for question q
+    std::vector<std::vector<std::vector<size_t>>> matchingAttempts;
+    std::vector<size_t> targets;
+    std::vector<PairConstraint> pairs;
+    std::vector<std::vector<size_t>> pairsByQuestion;
+    std::uint64_t allQuestions = 0;
+    
+    size_t nodes = 0;
+    size_t nodeBudget = 0;
+    bool exhausted = false;
+    
+    size_t numQuestions() const { return optionOf.size(); }
+    size_t numAttempts() const { return targets.size(); }
+    
+    // Pair up each attempt with recent attempts it barely differs from
+    void addPairConstraints(size_t window, int maxDiffering) {
+        pairsByQuestion.assign(numQuestions(), {});
+        for (size_t j = 1; j < numAttempts(); ++j) {
+            for (size_t i = j > window ? j - window : 0; i < j; ++i) {
+                std::uint64_t differing = 0;
+                for (size_t q = 0; q < numQuestions(); ++q) {
+                    if (optionOf[q][i] != optionOf[q][j]) {
+                        differing |= std::uint64_t(1) << q;
+                    }
+                }
+                if (differing == 0 || popcount64(differing) > maxDiffering) {
+                    continue;
+                }
+                
+                pairs.push_back({i, j, differing,
+                                 static_cast<long>(targets[i]) - static_cast<long>(targets[j])});
+                for (std::uint64_t rest = differing; rest; rest &= rest - 1) {
+                    pairsByQuestion[lowestBit(rest)].push_back(pairs.size() - 1);
+                }
+            }
+        }
     }
     
-    double mean = getAverageScore();
-    double sumSquares = std::accumulate(attempts.begin(), attempts.end(), 0.0,
-        [mean](double acc, const TestAttempt& attempt) {
-            double diff = attempt.percentage - mean;
-            return acc + (diff * diff);
-        });
+    KeyState initialState() const {
+        KeyState state;
+        for (const auto& options : matchingAttempts) {
+            state.domains.push_back(options.size() == 64 ? ~std::uint64_t(0)
+                                                         : (std::uint64_t(1) << options.size()) - 1);
+        }
+        state.correctMasks.assign(numAttempts(), 0);
+        state.incorrectMasks.assign(numAttempts(), 0);
+        return state;
+    }
+    
+    // Work items are attempt indices, or numAttempts() + pair index for pairs
+    std::vector<size_t> everything() const {
+        std::vector<size_t> queue(numAttempts() + pairs.size());
+        std::iota(queue.begin(), queue.end(), 0);
+        return queue;
+    }
+    
+    // Remove an option from a question and queue everything that depends on it
+    bool removeOption(KeyState& state, size_t q, size_t option, std::vector<size_t>& queue) const {
+        std::uint64_t optionBit = std::uint64_t(1) << option;
+        if (!(state.domains[q] & optionBit)) {
+            return true;
+        }
+        
+        state.domains[q] &= ~optionBit;
+        if (state.domains[q] == 0) {
+            return false;
+        }
+        
+        std::uint64_t questionBit = std::uint64_t(1) << q;
+        for (size_t i : matchingAttempts[q][option]) {
+            state.incorrectMasks[i] |= questionBit;
+            queue.push_back(i);
+        }
+        if (popcount64(state.domains[q]) == 1) {
+            for (size_t i : matchingAttempts[q][lowestBit(state.domains[q])]) {
+                state.correctMasks[i] |= questionBit;
+                queue.push_back(i);
+            }
+        }
+        for (size_t p : pairsByQuestion[q]) {
+            queue.push_back(numAttempts() + p);
+        }
+        return true;
+    }
+    
+    bool restrictTo(KeyState& state, size_t q, size_t option, std::vector<size_t>& queue) const {
+        if (!(state.domains[q] & (std::uint64_t(1) << option))) {
+            return false;
+        }
+        for (std::uint64_t rest = state.domains[q] & ~(std::uint64_t(1) << option); rest; rest &= rest - 1) {
+            if (!removeOption(state, q, lowestBit(rest), queue)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    bool propagate(KeyState& state, std::vector<size_t>& queue) const {
+        while (!queue.empty()) {
+            size_t item = queue.back();
+            queue.pop_back();
+            bool ok = item < numAttempts() ? propagateAttempt(state, item, queue)
+                                           : propagatePair(state, pairs[item - numAttempts()], queue);
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Find any complete key consistent with every attempt, starting from a
+    // propagated state
+    bool solve(KeyState& state) {
+        if (++nodes > nodeBudget) {
+            exhausted = true;
+            return false;
+        }
+        
+        // Branch on the open question with the fewest remaining options
+        size_t branchQuestion = numQuestions();
+        int fewestOptions = 65;
+        for (size_t q = 0; q < numQuestions(); ++q) {
+            int options = popcount64(state.domains[q]);
+            if (options > 1 && options < fewestOptions && hasOpenAttempts(state, q)) {
+                fewestOptions = options;
+                branchQuestion = q;
+            }
+        }
+        if (branchQuestion == numQuestions()) {
+            return true;
+        }
+        
+        // Try the options in order of how well they fit the attempts' remaining
+        // needs: an attempt that still needs c of its o open answers to be
+        // correct supports its own option with weight c/o
+        std::vector<std::pair<double, size_t>> order;
+        for (std::uint64_t rest = state.domains[branchQuestion]; rest; rest &= rest - 1) {
+            order.emplace_back(0.0, static_cast<size_t>(lowestBit(rest)));
+        }
+        std::uint64_t questionBit = std::uint64_t(1) << branchQuestion;
+        for (size_t i = 0; i < numAttempts(); ++i) {
+            std::uint64_t decided = state.correctMasks[i] | state.incorrectMasks[i];
+            if (decided & questionBit) {
+                continue;
+            }
+            double need = static_cast<double>(targets[i] - popcount64(state.correctMasks[i])) /
+                          popcount64(allQuestions & ~decided);
+            for (auto& [fit, option] : order) {
+                fit += std::log(option == optionOf[branchQuestion][i] ? need + 1e-9 : 1.0 - need + 1e-9);
+            }
+        }
+        std::stable_sort(order.begin(), order.end(),
+            [](const auto& a, const auto& b) { return a.first > b.first; });
+        
+        std::vector<size_t> queue;
+        for (const auto& [fit, option] : order) {
+            KeyState child = state;
+            queue.clear();
+            if (restrictTo(child, branchQuestion, option, queue) &&
+                propagate(child, queue) && solve(child)) {
+                state = std::move(child);
+                return true;
+            }
+            if (exhausted) {
+                return false;
+            }
+        }
+        return false;
+    }
+    
+private:
+    bool propagateAttempt(KeyState& state, size_t i, std::vector<size_t>& queue) const {
+        std::uint64_t undecided = allQuestions & ~(state.correctMasks[i] | state.incorrectMasks[i]);
+        size_t correct = static_cast<size_t>(popcount64(state.correctMasks[i]));
+        size_t open = static_cast<size_t>(popcount64(undecided));
+        if (correct > targets[i] || correct + open < targets[i]) {
+            return false;
+        }
+        
+        bool allIncorrect = correct == targets[i];
+        bool allCorrect = correct + open == targets[i];
+        for (; undecided && (allIncorrect || allCorrect); undecided &= undecided - 1) {
+            size_t q = static_cast<size_t>(lowestBit(undecided));
+            bool ok = allIncorrect ? removeOption(state, q, optionOf[q][i], queue)
+                                   : restrictTo(state, q, optionOf[q][i], queue);
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Each differing question contributes +1 if the first attempt got it
+    // right, -1 if the second did and 0 otherwise; the contributions must add
+    // up to the difference of the two targets
+    bool propagatePair(KeyState& state, const PairConstraint& pair, std::vector<size_t>& queue) const {
+        long low = 0;
+        long high = 0;
+        for (std::uint64_t rest = pair.differing; rest; rest &= rest - 1) {
+            size_t q = static_cast<size_t>(lowestBit(rest));
+            auto [termLow, termHigh] = pairTermRange(state, pair, q);
+            low += termLow;
+            high += termHigh;
+        }
+        if (pair.difference < low || pair.difference > high) {
+            return false;
+        }
+        if (pair.difference != low && pair.difference != high) {
+            return true;
+        }
+        
+        // Every term is pinned to its extreme
+        bool atHigh = pair.difference == high;
+        for (std::uint64_t rest = pair.differing; rest; rest &= rest - 1) {
+            size_t q = static_cast<size_t>(lowestBit(rest));
+            auto [termLow, termHigh] = pairTermRange(state, pair, q);
+            if (termLow == termHigh) {
+                continue;
+            }
+            size_t own = optionOf[q][atHigh ? pair.first : pair.second];
+            size_t other = optionOf[q][atHigh ? pair.second : pair.first];
+            bool ok = (atHigh ? termHigh : -termLow) == 1 ? restrictTo(state, q, own, queue)
+                                                          : removeOption(state, q, other, queue);
+            if (!ok) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    std::pair<long, long> pairTermRange(const KeyState& state, const PairConstraint& pair, size_t q) const {
+        std::uint64_t firstBit = std::uint64_t(1) << optionOf[q][pair.first];
+        std::uint64_t secondBit = std::uint64_t(1) << optionOf[q][pair.second];
+        bool first = state.domains[q] & firstBit;
+        bool second = state.domains[q] & secondBit;
+        bool neither = state.domains[q] & ~(firstBit | secondBit);
+        return {second ? -1 : (neither ? 0 : 1), first ? 1 : (neither ? 0 : -1)};
+    }
+    
+    bool hasOpenAttempts(const KeyState& state, size_t q) const {
+        for (std::uint64_t rest = state.domains[q]; rest; rest &= rest - 1) {
+            if (!matchingAttempts[q][lowestBit(rest)].empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+}  // namespace
+
+std::uint64_t AnswerAnalyzer::updatePossibleCombinations() const {
+    possibleCombinations.clear();
+    
+    size_t numQuestions = getFirstAttemptSize();
+    std::uint64_t allQuestions = numQuestions >= 64 ? ~std::uint64_t(0)
+                                                    : (std::uint64_t(1) << numQuestions) - 1;
+    if (attempts.empty() || numQuestions > 64) {
+        return allQuestions;
+    }
+    
+    KeySearch search;
+    search.allQuestions = allQuestions;
+    for (size_t i = 0; i < attempts.size(); ++i) {
+        search.targets.push_back(expectedCorrect(i));
+    }
+    
+    search.optionOf.resize(numQuestions);
+    search.matchingAttempts.resize(numQuestions);
+    for (size_t q = 0; q < numQuestions; ++q) {
+        // Domains are 64-bit masks, so at most 63 distinct answers plus an untried one
+        if (answerStats[q].size() > 63) {
+            return allQuestions;
+        }
+        
+        // Options are the interned answer ids, plus one past them for an untried answer
+        search.matchingAttempts[q].resize(attempts.numAnswers(q) + 1);
+        const AttemptStore::AnswerId* column = attempts.column(q);
+        for (size_t i = 0; i < attempts.size(); ++i) {
+            size_t option = column[i];
+            search.optionOf[q].push_back(option);
+            search.matchingAttempts[q][option].push_back(i);
+        }
+    }
+    
+    search.addPairConstraints(32, 8);
+    
+    KeyState root = search.initialState();
+    std::vector<size_t> queue = search.everything();
+    if (!search.propagate(root, queue)) {
+        return allQuestions;  // the recorded scores contradict each other
+    }
+    
+    // Probe each question of the latest attempt both ways. Every key found
+    // settles the question it was looking for and possibly many others.
+    const size_t reference = attempts.size() - 1;
+    std::uint64_t canBeCorrect = 0;
+    std::uint64_t canBeIncorrect = 0;
+    std::uint64_t unsettled = 0;
+    std::set<std::uint64_t> found;
+    
+    // Bound the effort: node cost grows with the number of attempts
+    const size_t probeBudget = 2000;
+    size_t totalBudget = 20000 * 32 / std::max<size_t>(32, attempts.size());
+    
+    for (size_t q = 0; q < numQuestions; ++q) {
+        std::uint64_t bit = std::uint64_t(1) << q;
+        size_t option = search.optionOf[q][reference];
+        
+        for (bool wantCorrect : {true, false}) {
+            if ((wantCorrect ? canBeCorrect : canBeIncorrect) & bit) {
+                continue;
+            }
+            
+            KeyState state = root;
+            queue.clear();
+            bool ok = wantCorrect ? search.restrictTo(state, q, option, queue)
+                                  : search.removeOption(state, q, option, queue);
+            
+            std::vector<std::uint64_t> masks;
+            bool solved = false;
+            search.nodes = 0;
+            search.nodeBudget = std::min(probeBudget, totalBudget);
+            search.exhausted = search.nodeBudget == 0;
+            if (ok && search.propagate(state, queue) && !search.exhausted) {
+                if (search.solve(state)) {
+                    masks = state.correctMasks;
+                    solved = true;
+                }
+                totalBudget -= std::min(totalBudget, search.nodes);
+            }
+            
+            if (solved && isValidCombination(masks)) {
+                std::uint64_t mask = masks[reference];
+                canBeCorrect |= mask;
+                canBeIncorrect |= ~mask & allQuestions;
+                found.insert(mask);
+            } else if (solved || search.exhausted) {
+                unsettled |= bit;
+            } else {
+                // Proven impossible: the opposite holds in every key, which
+                // narrows the search for the remaining questions
+                queue.clear();
+                ok = wantCorrect ? search.removeOption(root, q, option, queue)
+                                 : search.restrictTo(root, q, option, queue);
+                if (!ok || !search.propagate(root, queue)) {
+                    possibleCombinations.clear();
+                    return allQuestions;
+                }
+            }
+        }
+    }
+    
+    possibleCombinations.assign(found.begin(), found.end());
+    return unsettled;
+}
+
+void AnswerAnalyzer::updateDefiniteAnswers() const {
+    requireAttempts("Deducing definite answers");
+    // The bitmask search enumerates correctness patterns and slows down
+    // sharply past about 30 questions
+    bool useEngine = deductionBackend == DeductionBackend::CardinalitySolver ||
+        (deductionBackend == DeductionBackend::Automatic && getFirstAttemptSize() > 30);
+    if (useEngine && !attempts.empty()) {
+        solveWithDeductionEngine();
+        return;
+    }
+    
+    std::uint64_t unsettled = updatePossibleCombinations();
+    modelCount.reset();
+    
+    definiteAnswers.assign(std::max(maxAnswers, getFirstAttemptSize()), std::nullopt);
+    if (possibleCombinations.empty()) {
+        combinationsCalculated = true;
+        return;
+    }
+    
+    std::uint64_t alwaysCorrect = ~std::uint64_t(0);
+    std::uint64_t everCorrect = 0;
+    for (std::uint64_t mask : possibleCombinations) {
+        alwaysCorrect &= mask;
+        everCorrect |= mask;
+    }
+    
+    for (size_t q = 0; q < getFirstAttemptSize(); ++q) {
+        std::uint64_t bit = std::uint64_t(1) << q;
+        if (unsettled & bit) {
+            continue;
+        }
+        if (alwaysCorrect & bit) {
+            definiteAnswers[q] = true;
+        } else if (!(everCorrect & bit)) {
+            definiteAnswers[q] = false;
+        }
+    }
+    
+    combinationsCalculated = true;
+}
+
+// Solve for whole answer keys: option o of question q is each distinct answer
+// recorded for q, plus one extra option for an answer nobody has tried
+DeductionEngine AnswerAnalyzer::buildDeductionEngine() const {
+    const size_t numQuestions = attempts.numQuestions();
+    std::vector<std::vector<std::uint32_t>> optionOf(numQuestions);
+    std::vector<std::uint32_t> optionCounts(numQuestions);
+    for (size_t q = 0; q < numQuestions; ++q) {
+        optionCounts[q] = static_cast<std::uint32_t>(attempts.numAnswers(q) + 1);
+        const AttemptStore::AnswerId* column = attempts.column(q);
+        optionOf[q].assign(column, column + attempts.size());
+    }
+    
+    std::vector<size_t> targets;
+    targets.reserve(attempts.size());
+    for (size_t i = 0; i < attempts.size(); ++i) {
+        targets.push_back(expectedCorrect(i));
+    }
+    
+    return DeductionEngine(std::move(optionOf), optionCounts, std::move(targets));
+}
+
+void AnswerAnalyzer::solveWithDeductionEngine() const {
+    const size_t numQuestions = attempts.numQuestions();
+    std::vector<std::uint32_t> reference(numQuestions);
+    for (size_t q = 0; q < numQuestions; ++q) {
+        reference[q] = attempts.answerId(q, attempts.size() - 1);
+    }
     
-    return sumSquares / attempts.size();
+    DeductionEngine engine = buildDeductionEngine();
+    DeductionResult result = engine.solve();
+    
+    possibleCombinations.clear();
+    modelCount.reset();
+    if (result.countExact) {
+        modelCount = result.modelCount;
+    }
+    
+    // Report on the latest attempt, as the bitmask backend does
+    definiteAnswers.assign(std::max(maxAnswers, numQuestions), std::nullopt);
+    bool consistent = !(result.countExact && result.modelCount == 0.0);
+    for (size_t q = 0; q < numQuestions && consistent; ++q) {
+        const std::vector<bool>& possible = result.possible[q];
+        if (!possible[reference[q]]) {
+            definiteAnswers[q] = false;
+        } else if (std::count(possible.begin(), possible.end(), true) == 1) {
+            definiteAnswers[q] = true;
+        }
+    }
+    
+    combinationsCalculated = true;
+}
+
+const std::vector<std::optional<bool>>& AnswerAnalyzer::getDefiniteAnswers() const {
+    ANALYZER_PROFILE("AnswerAnalyzer::getDefiniteAnswers");
+    if (!combinationsCalculated) {
+        updateDefiniteAnswers();
+    }
+    return definiteAnswers;
+}
+
+const std::vector<std::uint64_t>& AnswerAnalyzer::getPossibleCombinations() const {
+    ANALYZER_PROFILE("AnswerAnalyzer::getPossibleCombinations");
+    if (!combinationsCalculated) {
+        updateDefiniteAnswers();
+    }
+    return possibleCombinations;
+}
+
+std::optional<double> AnswerAnalyzer::getModelCount() const {
+    ANALYZER_PROFILE("AnswerAnalyzer::getModelCount");
+    if (!combinationsCalculated) {
+        updateDefiniteAnswers();
+    }
+    return modelCount;
+}
+
+void AnswerAnalyzer::saveToFile(const std::string& filename, FileFormat format) const {
+    ANALYZER_PROFILE("AnswerAnalyzer::saveToFile");
+    requireAttempts("Saving");
+    replaceAttemptFile(attempts, filename, format);
+}
+
+void AnswerAnalyzer::loadFromFile(const std::string& filename) {
+    ANALYZER_PROFILE("AnswerAnalyzer::loadFromFile");
+    // Parse into a fresh store so a bad file leaves the current data alone
+    AttemptStore loaded = readAttemptFile(filename, maxAnswers);
+    
+    // The loaded history replaces the journaled one as a whole, so it goes
+    // straight to a new snapshot rather than through the journal
+    std::shared_ptr<AttemptJournal> attached = std::move(journal);
+    try {
+        clear();
+        if (fuzzyMatching) {
+            // Stored spellings are clustered like added ones
+            std::vector<TestAttempt> batch;
+            batch.reserve(loaded.size());
+            for (size_t i = 0; i < loaded.size(); ++i) {
+                batch.emplace_back(loaded.answers(i), loaded.percentage(i));
+            }
+            addAttempts(std::move(batch));
+        } else {
+            attempts = std::move(loaded);
+            rebuildSummaries();
+            rebuildScoreIndex();
+        }
+    } catch (...) {
+        journal = std::move(attached);
+        throw;
+    }
+    journal = std::move(attached);
+    if (journal) {
+        compactJournal();
+    }
+}
+
+void AnswerAnalyzer::openJournal(const std::string& path) {
+    openJournal(path, JournalOptions());
+}
+
+void AnswerAnalyzer::openJournal(const std::string& path, const JournalOptions& options) {
+    ANALYZER_PROFILE("AnswerAnalyzer::openJournal");
+    closeJournal();
+    auto opened = std::make_shared<AttemptJournal>(path, options);
+    std::error_code error;
+    const bool hasSnapshot = std::filesystem::exists(opened->getSnapshotPath(), error);
+    const bool existing = hasSnapshot || std::filesystem::exists(opened->getJournalPath(), error);
+    if (hasSnapshot) {
+        loadFromFile(path);
+    } else if (existing) {
+        clear();
+    } else {
+        requireAttempts("Journaling");
+    }
+    try {
+        addAttempts(opened->recover(attempts.size()));
+    } catch (const AttemptJournalException& e) {
+        throw AnswerAnalyzerException(e.what());
+    }
+    journal = std::move(opened);
+    if (!existing && !attempts.empty()) {
+        // A new journal starts from the data already here
+        compactJournal();
+    }
+}
+
+void AnswerAnalyzer::syncJournal() {
+    ANALYZER_PROFILE("AnswerAnalyzer::syncJournal");
+    requireJournal("Syncing");
+    try {
+        journal->sync();
+    } catch (const AttemptJournalException& e) {
+        throw AnswerAnalyzerException(e.what());
+    }
+}
+
+void AnswerAnalyzer::compactJournal() {
+    ANALYZER_PROFILE("AnswerAnalyzer::compactJournal");
+    requireJournal("Compacting");
+    const std::string tempPath = journal->getSnapshotPath() + ".tmp";
+    writeAttemptFile(attempts, tempPath, FileFormat::Binary);
+    try {
+        journal->commitSnapshot(tempPath, attempts.size());
+    } catch (const AttemptJournalException& e) {
+        throw AnswerAnalyzerException(e.what());
+    }
+}
+
+void AnswerAnalyzer::closeJournal() {
+    ANALYZER_PROFILE("AnswerAnalyzer::closeJournal");
+    if (!journal) {
+        return;
+    }
+    std::shared_ptr<AttemptJournal> closing = std::move(journal);
+    try {
+        closing->sync();
+    } catch (const AttemptJournalException& e) {
+        throw AnswerAnalyzerException(e.what());
+    }
+}
+
+void AnswerAnalyzer::streamFromFile(const std::string& filename) {
+    ANALYZER_PROFILE("AnswerAnalyzer::streamFromFile");
+    AnswerAnalyzer streamed(maxAnswers);
+    streamed.attempts.setRetainAttempts(false);
+    streamed.fuzzyMatching = fuzzyMatching;
+    
+    if (AttemptStore::isBinaryFile(filename) && fuzzyMatching) {
+        AttemptStore mapped = readAttemptFile(filename, maxAnswers);
+        for (size_t i = 0; i < mapped.size(); ++i) {
+            streamed.addAttempt(mapped.answers(i), mapped.percentage(i));
+        }
+    } else if (AttemptStore::isBinaryFile(filename)) {
+        // The mapped file is paged in on demand, so one column-major pass
+        // over it never needs the whole matrix in memory at once
+        streamed.attempts = readAttemptFile(filename, maxAnswers);
+        streamed.rebuildSummaries();
+        streamed.attempts.discardAttempts();
+    } else if (CompressedHistory::isCompressedFile(filename)) {
+        // Decoded one block at a time
+        try {
+            CompressedHistory history(filename);
+            for (size_t i = 0; i < history.size(); ++i) {
+                streamed.addAttempt(history.answers(i), history.percentage(i));
+            }
+        } catch (const CompressedHistoryException& e) {
+            throw AnswerAnalyzerException(e.what());
+        }
+    } else {
+        std::ifstream file;
+        std::vector<char> chunk(kStreamChunkBytes);
+        file.rdbuf()->pubsetbuf(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        file.open(filename);
+        if (!file) {
+            throw AnswerAnalyzerException("Cannot open file for reading: " + filename);
+        }
+        readTextAttempts(file, filename, maxAnswers,
+            [&streamed](const std::vector<std::string>& answers, double percentage) {
+                streamed.addAttempt(answers, percentage);
+            });
+    }
+    
+    // Keep this analyzer's settings; only the data is replaced. A summary
+    // cannot be journaled.
+    closeJournal();
+    clear();
+    attempts = std::move(streamed.attempts);
+    answerStats = std::move(streamed.answerStats);
+    answerIndexes = std::move(streamed.answerIndexes);
+    scoreMean = streamed.scoreMean;
+    scoreM2 = streamed.scoreM2;
+}
+
+void AnswerAnalyzer::dropAttempts() {
+    ANALYZER_PROFILE("AnswerAnalyzer::dropAttempts");
+    closeJournal();
+    attempts.discardAttempts();
+    scoreIndex = ScoreIndex();
+    patternAttempts.clear();
+    std::vector<std::pair<std::string, double>>().swap(cachedConfidences);
+    confidencesCalculated = false;
+    confidenceScratch = ConfidenceScratch();
+    std::vector<std::uint64_t>().swap(possibleCombinations);
+    combinationsCalculated = false;
+    modelCount.reset();
+    definiteAnswers.assign(maxAnswers, std::nullopt);
+}
+
+size_t AnswerAnalyzer::memoryUsage() const {
+    size_t bytes = attempts.memoryUsage() + scoreIndex.memoryUsage() +
+                   answerStats.capacity() * sizeof(std::vector<AnswerStats>);
+    for (const auto& questionStats : answerStats) {
+        bytes += questionStats.capacity() * sizeof(AnswerStats);
+    }
+    // Map nodes carry roughly four pointers of overhead
+    bytes += patternAttempts.size() * (2 * sizeof(size_t) + 4 * sizeof(void*));
+    for (const auto& [answer, confidence] : cachedConfidences) {
+        bytes += sizeof(std::pair<std::string, double>) + answer.capacity();
+    }
+    const ConfidenceScratch& scratch = confidenceScratch;
+    bytes += scratch.rankOrder.capacity() * sizeof(size_t);
+    bytes += (scratch.rankDecay.capacity() + scratch.rankWeights.capacity() +
+              scratch.rankScores.capacity() + scratch.weightedScores.capacity() +
+              scratch.totalWeights.capacity()) * sizeof(double) +
+             scratch.offsets.capacity() * sizeof(size_t) +
+             scratch.highScoreSuccesses.capacity() * sizeof(std::uint32_t);
+    return bytes;
+}
+
+std::vector<MethodMetrics> AnswerAnalyzer::getMetrics() {
+    return metrics::snapshot("AnswerAnalyzer::");
+}
+
+void AnswerAnalyzer::resetMetrics() {
+    metrics::reset();
+}
+
+void AnswerAnalyzer::setMetricsEnabled(bool enable) {
+    metrics::setEnabled(enable);
+}
+
+void AnswerAnalyzer::convertFile(const std::string& input, const std::string& output,
+                                 FileFormat format) {
+    ANALYZER_PROFILE("AnswerAnalyzer::convertFile");
+    // Nothing is analyzed, so there is no limit on the number of questions
+    replaceAttemptFile(readAttemptFile(input, std::numeric_limits<size_t>::max()), output, format);
+}
+
+// A loaded binary store is still mapped from its file, so writing over
+// that file in place would truncate the data being written. Write beside
+// it and rename over the target instead; a failed write also leaves the
+// old file whole.
+void AnswerAnalyzer::replaceAttemptFile(const AttemptStore& store, const std::string& filename,
+                                        FileFormat format) {
+    const std::string tempPath = filename + ".tmp";
+    std::error_code error;
+    try {
+        writeAttemptFile(store, tempPath, format);
+    } catch (...) {
+        std::filesystem::remove(tempPath, error);
+        throw;
+    }
+    std::filesystem::rename(tempPath, filename, error);
+    if (error) {
+        const std::string reason = error.message();
+        std::filesystem::remove(tempPath, error);
+        throw AnswerAnalyzerException("Cannot replace " + filename + ": " + reason);
+    }
 }
 
-void AnswerAnalyzer::saveToFile(const std::string& filename) const {
-    std::ofstream file(filename);
+void AnswerAnalyzer::writeAttemptFile(const AttemptStore& store, const std::string& filename,
+                                      FileFormat format) {
+    std::ofstream file;
+    if (format != FileFormat::Text) {
+        file.open(filename, std::ios::binary);
+    } else {
+        file.open(filename);
+    }
     if (!file) {
         throw AnswerAnalyzerException("Cannot open file for writing: " + filename);
     }
     
     try {
-        // Save number of attempts
-        file << attempts.size() << "\n";
-        
-        // Save each attempt
-        for (const auto& attempt : attempts) {
-            // Save number of answers
-            file << attempt.answers.size() << "\n";
+        if (format == FileFormat::Binary) {
+            store.writeBinary(file);
+        } else if (format == FileFormat::Compressed) {
+            CompressedHistory::write(store, file);
+        } else {
+            // Save number of attempts
+            file << store.size() << "\n";
             
-            // Save answers
-            for (const auto& answer : attempt.answers) {
-                file << answer << "\n";
+            // Save each attempt
+            for (size_t i = 0; i < store.size(); ++i) {
+                // Save number of answers
+                file << store.numQuestions() << "\n";
+                
+                // Save answers
+                for (size_t q = 0; q < store.numQuestions(); ++q) {
+                    file << store.answerText(q, store.answerId(q, i)) << "\n";
+                }
+                
+                // Save percentage
+                file << store.percentage(i) << "\n";
             }
-            
-            // Save percentage
-            file << attempt.percentage << "\n";
         }
         
         if (!file) {
@@ -307,52 +1642,104 @@ void AnswerAnalyzer::saveToFile(const std::string& filename) const {
     file.close();
 }
 
-void AnswerAnalyzer::loadFromFile(const std::string& filename) {
+AttemptStore AnswerAnalyzer::readAttemptFile(const std::string& filename, size_t maxQuestions) {
+    AttemptStore store;
+    
+    if (AttemptStore::isBinaryFile(filename)) {
+        try {
+            store = AttemptStore::mapBinary(filename);
+        } catch (const AttemptStoreException& e) {
+            throw AnswerAnalyzerException(e.what());
+        }
+        // The rules addAttempt enforces, checked without copying the matrix
+        if (!store.empty() && (store.numQuestions() == 0 || store.numQuestions() > maxQuestions)) {
+            throw AnswerAnalyzerException("Invalid number of answers");
+        }
+        for (size_t i = 0; i < store.size(); ++i) {
+            if (!(store.percentage(i) >= 0.0 && store.percentage(i) <= 100.0)) {
+                throw AnswerAnalyzerException("Percentage must be between 0 and 100");
+            }
+        }
+        return store;
+    }
+    
+    if (CompressedHistory::isCompressedFile(filename)) {
+        try {
+            CompressedHistory history(filename);
+            if (!history.empty() &&
+                (history.numQuestions() == 0 || history.numQuestions() > maxQuestions)) {
+                throw AnswerAnalyzerException("Invalid number of answers");
+            }
+            store = history.toStore();
+        } catch (const CompressedHistoryException& e) {
+            throw AnswerAnalyzerException(e.what());
+        }
+        for (size_t i = 0; i < store.size(); ++i) {
+            if (!(store.percentage(i) >= 0.0 && store.percentage(i) <= 100.0)) {
+                throw AnswerAnalyzerException("Percentage must be between 0 and 100");
+            }
+        }
+        return store;
+    }
+    
     std::ifstream file(filename);
     if (!file) {
         throw AnswerAnalyzerException("Cannot open file for reading: " + filename);
     }
+    readTextAttempts(file, filename, maxQuestions,
+        [&store](const std::vector<std::string>& answers, double percentage) {
+            try {
+                store.add(answers, percentage);
+            } catch (const AttemptStoreException& e) {
+                throw AnswerAnalyzerException(e.what());
+            }
+        });
+    return store;
+}
+
+// Parse the text format record by record, handing each attempt to onAttempt
+void AnswerAnalyzer::readTextAttempts(std::istream& file, const std::string& filename,
+    size_t maxQuestions, const std::function<void(const std::vector<std::string>&, double)>& onAttempt) {
+    // Read number of attempts
+    size_t numAttempts;
+    file >> numAttempts;
+    file.ignore(); // Skip newline
     
-    try {
-        clear();
-        
-        // Read number of attempts
-        size_t numAttempts;
-        file >> numAttempts;
+    // Read each attempt
+    std::vector<std::string> answers;
+    for (size_t i = 0; i < numAttempts && file; ++i) {
+        // Read number of answers
+        size_t numAnswers;
+        file >> numAnswers;
         file.ignore(); // Skip newline
+        if (!file) {
+            break;
+        }
+        if (numAnswers == 0 || numAnswers > maxQuestions) {
+            throw AnswerAnalyzerException("Invalid number of answers");
+        }
         
-        // Read each attempt
-        for (size_t i = 0; i < numAttempts; ++i) {
-            // Read number of answers
-            size_t numAnswers;
-            file >> numAnswers;
-            file.ignore(); // Skip newline
-            
-            std::vector<std::string> answers;
-            
-            // Read answers
-            for (size_t j = 0; j < numAnswers; ++j) {
-                std::string answer;
-                std::getline(file, answer);
-                answers.push_back(answer);
-            }
-            
-            // Read percentage
-            double percentage;
-            file >> percentage;
-            file.ignore(); // Skip newline
-            
-            addAttempt(answers, percentage);
+        // Read answers
+        answers.resize(numAnswers);
+        for (size_t j = 0; j < numAnswers; ++j) {
+            std::getline(file, answers[j]);
         }
         
-        if (file.fail() && !file.eof()) {
-            throw AnswerAnalyzerException("Error reading from file: " + filename);
+        // Read percentage
+        double percentage;
+        file >> percentage;
+        file.ignore(); // Skip newline
+        if (!file) {
+            break;
         }
-    }
-    catch (...) {
-        file.close();
-        throw;
+        if (percentage < 0.0 || percentage > 100.0) {
+            throw AnswerAnalyzerException("Percentage must be between 0 and 100");
+        }
+        
+        onAttempt(answers, percentage);
     }
     
-    file.close();
+    if (file.fail() && !file.eof()) {
+        throw AnswerAnalyzerException("Error reading from file: " + filename);
+    }
 }
\ No newline at end of file
@@ -1,6 +1,15 @@
 #ifndef ANSWER_ANALYZER_H
 #define ANSWER_ANALYZER_H
 
+#include "analyzerMetrics.h"
+#include "attemptStore.h"
+#include "fuzzyMatch.h"
+#include "scoreIndex.h"
+#include "suggestionSearch.h"
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
 #include <string>
 #include <vector>
 #include <set>
@@ -15,59 +24,226 @@ public:
         : std::runtime_error(message) {}
 };
 
+// Running statistics for one answer given to one question
+struct AnswerStats {
+    size_t count = 0;
+    size_t lowScoreCount = 0;  // attempts scoring below 20%
+    double scoreMean = 0.0;    // running Welford mean
+    double scoreM2 = 0.0;      // running Welford sum of squared deviations
+};
+
+// How definite answers are deduced from the recorded scores
+enum class DeductionBackend {
+    Automatic,          // bitmask search for small tests, cardinality solver beyond
+    BitmaskSearch,      // per-question probing over 64-bit masks; up to 64 questions
+    CardinalitySolver   // DeductionEngine; any number of questions, reports model count
+};
+
+// On-disk formats for saved attempts
+enum class FileFormat {
+    Text,        // one value per line, human readable
+    Binary,      // versioned, memory-mapped on load; see AttemptStore::writeBinary
+    Compressed   // attempts as deltas in LZ-compressed blocks; see CompressedHistory
+};
+
+struct JournalOptions;
+
 struct TestAttempt {
     std::vector<std::string> answers;
     double percentage;
     
     TestAttempt(const std::vector<std::string>& ans, double perc) 
         : answers(ans), percentage(perc) {}
+    TestAttempt(std::vector<std::string>&& ans, double perc)
+        : answers(std::move(ans)), percentage(perc) {}
 };
 
+class AnswerScorer;
+class AttemptJournal;
+class DeductionEngine;
+class ThreadPool;
+
 class AnswerAnalyzer {
 private:
-    std::vector<TestAttempt> attempts;
+    AttemptStore attempts;  // interned answers, column-major
     size_t maxAnswers;
-    std::vector<std::vector<bool>> possibleCombinations;
-    bool combinationsCalculated;
-    std::vector<std::optional<bool>> definiteAnswers;  // true = correct, false = incorrect, nullopt = unknown
+    // Distinct correctness masks (bit q = question q) of the latest attempt
+    // found consistent with every recorded score; solved lazily on demand
+    mutable std::vector<std::uint64_t> possibleCombinations;
+    mutable bool combinationsCalculated;
+    mutable std::vector<std::optional<bool>> definiteAnswers;  // true = correct, false = incorrect, nullopt = unknown
+    mutable std::optional<double> modelCount;  // consistent answer keys, if counted exactly
+    DeductionBackend deductionBackend;
+    
+    // Incrementally maintained summaries, updated by addAttempt in O(Q)
+    std::vector<std::vector<AnswerStats>> answerStats;  // [question][answer id]
+    double scoreMean;                  // running Welford mean
+    double scoreM2;                    // running Welford sum of squared deviations
+    ScoreIndex scoreIndex;             // attempts by descending percentage
+    std::map<size_t, size_t> patternAttempts;  // rounded score -> latest attempt index
+    
+    // Per-question confidences are expensive to compute, so they are cached
+    // until the attempt history changes
+    mutable std::vector<std::pair<std::string, double>> cachedConfidences;
+    mutable bool confidencesCalculated;
+    
+    // Working buffers for recomputing the confidences, kept between calls so
+    // that once they have grown to the history's size a recomputation does
+    // not allocate. Tallies are indexed by offsets[q] + answer id.
+    struct ConfidenceScratch {
+        std::vector<double> rankDecay;          // [rank] exp(-0.1 * rank), only ever extended
+        std::vector<size_t> rankOrder;          // [rank] attempt, for the ranks that carry weight
+        std::vector<double> rankWeights;        // [rank]
+        std::vector<double> rankScores;         // [rank] percentage of the attempt at that rank
+        std::vector<size_t> offsets;            // [question], plus the total
+        std::vector<double> weightedScores;
+        std::vector<double> totalWeights;
+        std::vector<std::uint32_t> highScoreSuccesses;
+    };
+    mutable ConfidenceScratch confidenceScratch;
+    
+    // Worker pool for per-question analysis; null runs everything serially.
+    // Copies of an analyzer share the pool.
+    std::shared_ptr<ThreadPool> threadPool;
+    
+    // Replaces the built-in confidence heuristic when set. Copies of an
+    // analyzer share the scorer and with it any warm-start state.
+    std::shared_ptr<AnswerScorer> scorer;
+    
+    // Near-duplicate answers are merged into one spelling per cluster as
+    // attempts come in, while fuzzy matching is on
+    std::optional<FuzzyMatchOptions> fuzzyMatching;
+    std::vector<FuzzyAnswerIndex> answerIndexes;  // [question]
+    std::vector<size_t> clusterCounts;  // [question] before the last clusterAnswers
+    
+    // Write-ahead journal every added attempt goes to, while one is open.
+    // Copies of an analyzer share it, so only one of them should add.
+    std::shared_ptr<AttemptJournal> journal;
+    
+    void validateAttempt(const std::vector<std::string>& answers, double percentage,
+                         size_t numQuestions) const;
+    void clusterAnswers(std::vector<std::string>& answers);
+    void unclusterAnswers();
+    void updateSummaries(double percentage, bool indexAttempt = true);
+    void rebuildSummaries();
+    void rebuildScoreIndex();
+    void requireAttempts(const char* operation) const;
+    void journalAttempts(size_t first);
+    void requireJournal(const char* operation) const;
+    void forEachIndex(size_t count, size_t grain,
+                      const std::function<void(size_t, size_t)>& body) const;
+    const std::vector<std::pair<std::string, double>>& confidences() const;
+    std::pair<const std::string*, double> questionConfidence(size_t q, size_t highScoreTotal) const;
+    std::vector<double> questionWeights() const;
+    double predictScoreWithWeights(const std::vector<std::string>& answers,
+                                   const std::vector<double>& weights) const;
+    
+    size_t expectedCorrect(size_t attemptIndex) const;
+    std::uint64_t updatePossibleCombinations() const;  // returns questions left unsettled
+    bool isValidCombination(const std::vector<std::uint64_t>& correctMasks) const;
+    void updateDefiniteAnswers() const;
+    DeductionEngine buildDeductionEngine() const;
+    void solveWithDeductionEngine() const;
+    std::vector<std::vector<AttemptStore::AnswerId>> sampleAnswerKeys(const SuggestionOptions& options) const;
     
-    void updatePossibleCombinations();
-    bool isValidCombination(const std::vector<bool>& combination) const;
-    void updateDefiniteAnswers();
+    static AttemptStore readAttemptFile(const std::string& filename, size_t maxQuestions);
+    static void readTextAttempts(std::istream& file, const std::string& filename, size_t maxQuestions,
+        const std::function<void(const std::vector<std::string>&, double)>& onAttempt);
+    static void writeAttemptFile(const AttemptStore& store, const std::string& filename,
+                                 FileFormat format);
+    static void replaceAttemptFile(const AttemptStore& store, const std::string& filename,
+                                   FileFormat format);
     
 public:
     // Constructor
     AnswerAnalyzer(size_t maxAns = 10) 
-        : maxAnswers(maxAns), combinationsCalculated(false) {
+        : maxAnswers(maxAns), combinationsCalculated(false),
+          deductionBackend(DeductionBackend::Automatic), scoreMean(0.0), scoreM2(0.0), confidencesCalculated(false) {
         definiteAnswers.resize(maxAnswers);
     }
     
     // Core functionality
     void addAttempt(const std::vector<std::string>& answers, double percentage);
+    void addAttempt(std::vector<std::string>&& answers, double percentage);
+    // Add a batch, moving the answers in. Scores and answer counts of the
+    // whole batch are checked before anything is stored, and storage is
+    // reserved once for all of it.
+    void addAttempts(std::vector<TestAttempt>&& batch);
     void analyzeResults() const;
     void clear();
+    void setDeductionBackend(DeductionBackend backend);
+    void setThreadCount(size_t threads);  // 1 = serial, 0 = one per core
+    // Score answers with this model instead of the built-in heuristic; null
+    // restores the heuristic. Affects everything built on the confidences.
+    void setScorer(std::shared_ptr<AnswerScorer> answerScorer);
+    // Trim, case-fold and merge answers within the allowed edits of an
+    // earlier one into its spelling (see FuzzyAnswerIndex) before they are
+    // stored, for added and loaded attempts alike; nullopt stores answers
+    // as given. Only possible while the analyzer is empty.
+    void setFuzzyMatching(std::optional<FuzzyMatchOptions> options);
     
     // Analysis methods
     std::vector<std::string> getMostCommonAnswers() const;
     std::vector<std::pair<std::string, double>> getAnswerConfidences() const;
+    // Same, into a caller-owned vector; reusing it across calls avoids all
+    // heap allocation once the analyzer's buffers have grown
+    void getAnswerConfidences(std::vector<std::pair<std::string, double>>& out) const;
     std::map<size_t, std::vector<std::string>> getAnswerPatterns() const;
-    std::vector<std::string> suggestNextAttempt() const;
+    std::vector<std::string> suggestNextAttempt() const;  // information gain, default budget
+    std::vector<std::string> suggestNextAttempt(const SuggestionOptions& options) const;
     double predictScore(const std::vector<std::string>& answers) const;
+    std::vector<double> predictScores(const std::vector<std::vector<std::string>>& candidates) const;
     
     // Statistics
     double getAverageScore() const;
     double getScoreVariance() const;
     
     // File operations
-    void saveToFile(const std::string& filename) const;
-    void loadFromFile(const std::string& filename);
+    void saveToFile(const std::string& filename, FileFormat format = FileFormat::Text) const;
+    void loadFromFile(const std::string& filename);  // detects the format
+    // Fold a file of any size into the summaries without keeping its
+    // attempts. Afterwards only the summary queries (counts, most common
+    // answers, score statistics) are available; the rest throw.
+    void streamFromFile(const std::string& filename);
+    // Release the stored attempts but keep the summaries, leaving the same
+    // summary-only state as streamFromFile
+    void dropAttempts();
+    // Keep the history in a binary snapshot at path plus a journal of the
+    // attempts added since (see AttemptJournal). Existing files replace the
+    // current data with what they hold; otherwise they are started from
+    // it. Each added attempt then costs one O(Q) append;
+    // the journal is folded into a new snapshot once it reaches
+    // JournalOptions::compactAfter records, and by clear() and
+    // loadFromFile(). streamFromFile() and dropAttempts() close it.
+    void openJournal(const std::string& path);
+    void openJournal(const std::string& path, const JournalOptions& options);
+    void syncJournal();     // write and fsync records still buffered
+    void compactJournal();  // fold the journal into a new snapshot now
+    void closeJournal();    // sync and stop journaling
+    static void convertFile(const std::string& input, const std::string& output, FileFormat format);
     
     // Getters
-    const std::vector<std::optional<bool>>& getDefiniteAnswers() const { return definiteAnswers; }
+    const std::vector<std::optional<bool>>& getDefiniteAnswers() const;
+    const std::vector<std::uint64_t>& getPossibleCombinations() const;  // bitmask backend only
+    std::optional<double> getModelCount() const;  // cardinality solver only
+    DeductionBackend getDeductionBackend() const { return deductionBackend; }
     size_t getNumAttempts() const { return attempts.size(); }
+    bool isSummaryOnly() const { return !attempts.retainsAttempts(); }
+    TestAttempt getAttempt(size_t index) const;
+    const AttemptStore& getAttemptStore() const { return attempts; }
     size_t getMaxAnswers() const { return maxAnswers; }
+    size_t getThreadCount() const;
+    std::shared_ptr<AnswerScorer> getScorer() const { return scorer; }
+    const std::optional<FuzzyMatchOptions>& getFuzzyMatching() const { return fuzzyMatching; }
+    bool hasJournal() const { return journal != nullptr; }
+    size_t memoryUsage() const;  // approximate heap bytes held for the attempts and summaries
+    // Call counts, times and allocations of the instrumented methods, summed
+    // over every analyzer in the process; the reset covers AnswerTracker too
+    static std::vector<MethodMetrics> getMetrics();
+    static void resetMetrics();
+    static void setMetricsEnabled(bool enable);  // off by default
     size_t getFirstAttemptSize() const { 
-        return attempts.empty() ? maxAnswers : attempts[0].answers.size(); 
+        return attempts.empty() ? maxAnswers : attempts.numQuestions(); 
     }
 };
 
@@ -0,0 +1,25 @@
+#ifndef ANSWER_SCORER_H
+#define ANSWER_SCORER_H
+
+#include "attemptStore.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// Pluggable replacement for the analyzer's built-in confidence heuristic.
+// AnswerAnalyzer calls score whenever its confidences are needed and the
+// history has changed since the last call, and reset whenever the history
+// is replaced rather than extended, so a scorer may keep state between
+// calls to warm-start from its previous fit.
+class AnswerScorer {
+public:
+    virtual ~AnswerScorer() = default;
+
+    // Best answer and its confidence in [0, 100] for every question
+    virtual void score(const AttemptStore& attempts,
+                       std::vector<std::pair<std::string, double>>& result) = 0;
+    // Forget anything learned from earlier histories
+    virtual void reset() = 0;
+};
+
+#endif
@@ -4,15 +4,13 @@
 #include <iomanip>
 #include <fstream>
 
-// Constructor
-AnswerTracker::AnswerTracker() 
-    : successPercentage(0.0), maxAnswers(10) {}
 
-// Helper function to convert string to lowercase
-std::string AnswerTracker::toLowerCase(const std::string& str) const {
-    std::string result = str;
-    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
-    return result;
+// Constructor
+AnswerTracker::AnswerTracker(size_t maxAnswerCount, size_t maxLength) 
+    : successPercentage(0.0), maxAnswers(maxAnswerCount), maxAnswerLength(maxLength) {
+    if (maxAnswers == 0) {
+        throw AnswerTrackerException("Maximum number of answers must be positive");
+    }
 }
 
 // Input validation helper
@@ -20,13 +18,15 @@ void AnswerTracker::validateInput(const std::string& input) const {
     if (input.empty()) {
         throw AnswerTrackerException("Input cannot be empty");
     }
-    if (input.length() > 100) {
-        throw AnswerTrackerException("Input is too long (max 100 characters)");
+    if (input.length() > maxAnswerLength) {
+        throw AnswerTrackerException("Input is too long (max " + std::to_string(maxAnswerLength) +
+                                     " characters)");
     }
 }
 
 // Core function to add an answer pair
 bool AnswerTracker::addAnswer(const std::string& expected, const std::string& actual) {
+    ANALYZER_PROFILE("AnswerTracker::addAnswer");
     try {
         validateInput(expected);
         validateInput(actual);
@@ -36,6 +36,9 @@ bool AnswerTracker::addAnswer(const std::string& expected, const std::string& ac
         }
         
         answerPairs.emplace_back(expected, actual);
+        if (fuzzyMatching) {
+            answerPairs.back().nearMatch = answersNear(expected, actual, *fuzzyMatching);
+        }
         return true;
     }
     catch (const AnswerTrackerException& e) {
@@ -45,6 +48,7 @@ bool AnswerTracker::addAnswer(const std::string& expected, const std::string& ac
 
 // Calculate success percentage
 void AnswerTracker::setSuccessPercentage() {
+    ANALYZER_PROFILE("AnswerTracker::setSuccessPercentage");
     if (answerPairs.empty()) {
         successPercentage = 0.0;
         return;
@@ -52,7 +56,7 @@ void AnswerTracker::setSuccessPercentage() {
     
     size_t correctCount = 0;
     for (const auto& pair : answerPairs) {
-        if (toLowerCase(pair.expected) == toLowerCase(pair.actual)) {
+        if (pair.matches()) {
             correctCount++;
         }
     }
@@ -60,36 +64,44 @@ void AnswerTracker::setSuccessPercentage() {
     successPercentage = (static_cast<double>(correctCount) / answerPairs.size()) * 100.0;
 }
 
-// Analyze and return results
-std::vector<std::tuple<int, bool, std::string, std::string>> 
-AnswerTracker::analyzeResults() const {
-    std::vector<std::tuple<int, bool, std::string, std::string>> results;
-    
-    for (size_t i = 0; i < answerPairs.size(); ++i) {
-        const auto& pair = answerPairs[i];
-        bool isCorrect = toLowerCase(pair.expected) == toLowerCase(pair.actual);
-        results.emplace_back(i + 1, isCorrect, pair.expected, pair.actual);
+void AnswerTracker::setFuzzyMatching(std::optional<FuzzyMatchOptions> options) {
+    ANALYZER_PROFILE("AnswerTracker::setFuzzyMatching");
+    fuzzyMatching = options;
+    for (AnswerPair& pair : answerPairs) {
+        pair.nearMatch = fuzzyMatching && answersNear(pair.expected, pair.actual, *fuzzyMatching);
     }
-    
-    return results;
 }
 
-// Display results to console
-void AnswerTracker::displayResults() const {
-    std::cout << "\n=== Results Analysis ===" << std::endl;
-    std::cout << "Total Questions: " << answerPairs.size() << std::endl;
-    std::cout << "Success Rate: " << std::fixed << std::setprecision(1) 
-              << successPercentage << "%" << std::endl << std::endl;
+// Analyze results lazily over the stored pairs
+AnswerResultView AnswerTracker::analyzeResults() const {
+    ANALYZER_PROFILE("AnswerTracker::analyzeResults");
+    const AnswerPair* pairs = answerPairs.data();
+    return AnswerResultView(pairs, pairs + answerPairs.size());
+}
+
+// Display results, streaming each one straight from the stored pairs
+void AnswerTracker::displayResults(std::ostream& out) const {
+    ANALYZER_PROFILE("AnswerTracker::displayResults");
+    out << "\n=== Results Analysis ===" << std::endl;
+    out << "Total Questions: " << answerPairs.size() << std::endl;
+    out << "Success Rate: " << std::fixed << std::setprecision(1) 
+        << successPercentage << "%" << std::endl << std::endl;
     
-    for (const auto& [num, correct, expected, actual] : analyzeResults()) {
-        std::cout << "Question " << num << ": " << (correct ? "✓" : "✗") << std::endl;
-        std::cout << "  Expected: " << expected << std::endl;
-        std::cout << "  Actual: " << actual << std::endl << std::endl;
+    for (const AnswerResult result : analyzeResults()) {
+        out << "Question " << result.number << ": " << (result.correct() ? "✓" : "✗") << "\n"
+            << "  Expected: " << result.expected << "\n"
+            << "  Actual: " << result.actual << "\n\n";
     }
+    out.flush();
+}
+
+std::vector<MethodMetrics> AnswerTracker::getMetrics() {
+    return metrics::snapshot("AnswerTracker::");
 }
 
 // Save results to file
 void AnswerTracker::saveToFile(const std::string& filename) const {
+    ANALYZER_PROFILE("AnswerTracker::saveToFile");
     std::ofstream file(filename);
     if (!file) {
         throw AnswerTrackerException("Cannot open file for writing: " + filename);
@@ -119,6 +131,7 @@ void AnswerTracker::saveToFile(const std::string& filename) const {
 
 // Load results from file
 void AnswerTracker::loadFromFile(const std::string& filename) {
+    ANALYZER_PROFILE("AnswerTracker::loadFromFile");
     std::ifstream file(filename);
     if (!file) {
         throw AnswerTrackerException("Cannot open file for reading: " + filename);
@@ -171,7 +184,7 @@ void AnswerTracker::interactiveInput() {
             std::cout << "Enter expected answer (or 'quit' to finish): ";
             std::getline(std::cin, expected);
             
-            if (toLowerCase(expected) == "quit") {
+            if (equalsIgnoreCase(expected, "quit")) {
                 break;
             }
             
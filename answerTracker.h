@@ -1,11 +1,18 @@
 #ifndef ANSWER_TRACKER_H
 #define ANSWER_TRACKER_H
 
+#include "analyzerMetrics.h"
+#include "caseFold.h"
+#include "fuzzyMatch.h"
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <utility>
 #include <stdexcept>
-#include <tuple>
 
 // Custom exception class for AnswerTracker-specific errors
 class AnswerTrackerException : public std::runtime_error {
@@ -14,13 +21,77 @@ public:
         : std::runtime_error(message) {}
 };
 
-// Structure to hold a pair of expected and actual answers
+// Structure to hold a pair of expected and actual answers, with both
+// case-folded once so grading is a plain comparison
 struct AnswerPair {
     std::string expected;
     std::string actual;
+    std::string foldedExpected;
+    std::string foldedActual;
+    bool nearMatch = false;  // close enough under the tracker's fuzzy matching
     
     AnswerPair(const std::string& exp, const std::string& act) 
-        : expected(exp), actual(act) {}
+        : expected(exp), actual(act), foldedExpected(exp), foldedActual(act) {
+        foldCase(foldedExpected);
+        foldCase(foldedActual);
+    }
+    
+    bool matches() const { return nearMatch || foldedExpected == foldedActual; }
+};
+
+// One analyzed answer pair. The answers refer to the tracker's storage and
+// are only valid while it is unchanged; correctness is worked out on demand.
+struct AnswerResult {
+    size_t number;  // 1-based question number
+    std::string_view expected;
+    std::string_view actual;
+    const AnswerPair* pair;
+    
+    bool correct() const { return pair->matches(); }
+};
+
+// Lazy range over a tracker's results, producing one AnswerResult per
+// stored pair as it is iterated without copying any answer
+class AnswerResultView {
+private:
+    const AnswerPair* first;
+    const AnswerPair* last;
+
+public:
+    class iterator {
+    private:
+        const AnswerPair* base;
+        const AnswerPair* current;
+
+    public:
+        // Results are made on dereference, so this is only an input
+        // iterator and has no operator->
+        typedef std::input_iterator_tag iterator_category;
+        typedef AnswerResult value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef void pointer;
+        typedef AnswerResult reference;
+
+        iterator() : base(nullptr), current(nullptr) {}
+        iterator(const AnswerPair* start, const AnswerPair* position)
+            : base(start), current(position) {}
+
+        AnswerResult operator*() const {
+            return {static_cast<size_t>(current - base) + 1, current->expected, current->actual,
+                    current};
+        }
+        iterator& operator++() { ++current; return *this; }
+        iterator operator++(int) { iterator previous = *this; ++current; return previous; }
+        bool operator==(const iterator& other) const { return current == other.current; }
+        bool operator!=(const iterator& other) const { return current != other.current; }
+    };
+
+    AnswerResultView(const AnswerPair* begin, const AnswerPair* end) : first(begin), last(end) {}
+
+    iterator begin() const { return iterator(first, first); }
+    iterator end() const { return iterator(first, last); }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
 };
 
 class AnswerTracker {
@@ -28,20 +99,27 @@ private:
     std::vector<AnswerPair> answerPairs;
     double successPercentage;
     const size_t maxAnswers;
+    const size_t maxAnswerLength;
+    std::optional<FuzzyMatchOptions> fuzzyMatching;
     
     // Helper functions
-    std::string toLowerCase(const std::string& str) const;
     void validateInput(const std::string& input) const;
 
 public:
-    // Constructor
-    AnswerTracker();
+    // Constructor; the defaults suit one interactive sheet, see BulkGrader
+    // for grading many sheets against one key
+    explicit AnswerTracker(size_t maxAnswerCount = 10, size_t maxLength = 100);
     
     // Core functionality
     bool addAnswer(const std::string& expected, const std::string& actual);
     void setSuccessPercentage();
-    std::vector<std::tuple<int, bool, std::string, std::string>> analyzeResults() const;
-    void displayResults() const;
+    // Also accept answers that differ only in spacing, non-ASCII case or
+    // the allowed edits (see answersNear); nullopt compares ignoring ASCII
+    // case only. Applies to the stored pairs too.
+    void setFuzzyMatching(std::optional<FuzzyMatchOptions> options);
+    // Valid until the tracker's answers change
+    AnswerResultView analyzeResults() const;
+    void displayResults(std::ostream& out = std::cout) const;
     
     // File operations
     void saveToFile(const std::string& filename) const;
@@ -54,6 +132,9 @@ public:
     double getSuccessPercentage() const { return successPercentage; }
     size_t getTotalAnswers() const { return answerPairs.size(); }
     size_t getMaxAnswers() const { return maxAnswers; }
+    size_t getMaxAnswerLength() const { return maxAnswerLength; }
+    const std::optional<FuzzyMatchOptions>& getFuzzyMatching() const { return fuzzyMatching; }
+    static std::vector<MethodMetrics> getMetrics();  // summed over every tracker
     
     // Utility functions
     void clear() { answerPairs.clear(); successPercentage = 0.0; }
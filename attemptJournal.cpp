@@ -0,0 +1,337 @@
+#include "attemptJournal.h"
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ATTEMPT_JOURNAL_FSYNC 1
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char kJournalMagic[8] = {'A', 'A', 'J', 'O', 'U', 'R', 'N', '1'};
+const size_t kHeaderBytes = 16;
+const size_t kRecordHeaderBytes = 8;
+const std::uint32_t kMaxPayloadBytes = 1u << 30;
+
+// CRC-32 as in zlib and PNG (reflected polynomial 0xEDB88320)
+std::uint32_t crc32(const char* data, size_t size) {
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> entries{};
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[n] = c;
+        }
+        return entries;
+    }();
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// Integers are stored little-endian whatever the host order
+void putU32(std::string& out, std::uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+void putU64(std::string& out, std::uint64_t value) {
+    putU32(out, static_cast<std::uint32_t>(value));
+    putU32(out, static_cast<std::uint32_t>(value >> 32));
+}
+
+std::uint32_t getU32(const char* data) {
+    std::uint32_t value = 0;
+    for (int i = 3; i >= 0; --i) {
+        value = (value << 8) | static_cast<unsigned char>(data[i]);
+    }
+    return value;
+}
+
+std::uint64_t getU64(const char* data) {
+    return getU32(data) | (std::uint64_t(getU32(data + 4)) << 32);
+}
+
+void storeU32(char* data, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        data[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+// Payload of one record, or false if it does not parse exactly
+bool decodePayload(const char* data, size_t size, std::vector<std::string>& answers,
+                   double& percentage) {
+    if (size < 12) {
+        return false;
+    }
+    const std::uint64_t bits = getU64(data);
+    std::memcpy(&percentage, &bits, sizeof(percentage));
+    const std::uint32_t count = getU32(data + 8);
+    size_t offset = 12;
+    answers.clear();
+    for (std::uint32_t q = 0; q < count; ++q) {
+        if (size - offset < 4) {
+            return false;
+        }
+        const std::uint32_t length = getU32(data + offset);
+        offset += 4;
+        if (size - offset < length) {
+            return false;
+        }
+        answers.emplace_back(data + offset, length);
+        offset += length;
+    }
+    return offset == size;
+}
+
+// Make a file's contents, or a directory's entries, durable
+void syncPath(const std::string& path) {
+#ifdef ATTEMPT_JOURNAL_FSYNC
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw AttemptJournalException("Cannot open for syncing: " + path);
+    }
+    const bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    if (!synced) {
+        throw AttemptJournalException("Cannot sync: " + path);
+    }
+#else
+    (void)path;
+#endif
+}
+
+void syncDirectoryOf(const std::string& path) {
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    syncPath(directory.empty() ? std::string(".") : directory.string());
+}
+
+void renameFile(const std::string& from, const std::string& to) {
+    std::error_code error;
+    std::filesystem::rename(from, to, error);
+    if (error) {
+        throw AttemptJournalException("Cannot rename " + from + " to " + to + ": " +
+                                      error.message());
+    }
+}
+
+}  // namespace
+
+AttemptJournal::AttemptJournal(const std::string& snapshotPath, const JournalOptions& journalOptions)
+    : options(journalOptions), snapshotFile(snapshotPath), journalFile(snapshotPath + ".journal"),
+      file(nullptr), pendingRecords(0), journalRecords(0), baseAttempts(0), syncedBytes(0) {}
+
+AttemptJournal::~AttemptJournal() {
+    try {
+        sync();
+    } catch (const AttemptJournalException&) {
+        // Nothing to report to from a destructor; the records are lost as
+        // they would be in a crash
+    }
+    closeFile();
+}
+
+void AttemptJournal::openForAppend() {
+    file = std::fopen(journalFile.c_str(), "ab");
+    if (!file) {
+        throw AttemptJournalException("Cannot open journal for appending: " + journalFile);
+    }
+}
+
+void AttemptJournal::closeFile() {
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+// Replace the journal with one extending a snapshot of attempts attempts
+// and holding the given encoded records
+void AttemptJournal::writeJournal(std::uint64_t attempts, const std::string& records) {
+    std::string header(kJournalMagic, sizeof(kJournalMagic));
+    putU64(header, attempts);
+
+    const std::string tempFile = journalFile + ".tmp";
+    std::FILE* out = std::fopen(tempFile.c_str(), "wb");
+    if (!out) {
+        throw AttemptJournalException("Cannot open file for writing: " + tempFile);
+    }
+    const bool written = std::fwrite(header.data(), 1, header.size(), out) == header.size() &&
+                         std::fwrite(records.data(), 1, records.size(), out) == records.size() &&
+                         std::fflush(out) == 0;
+    std::fclose(out);
+    if (!written) {
+        throw AttemptJournalException("Error writing to file: " + tempFile);
+    }
+    syncPath(tempFile);
+    renameFile(tempFile, journalFile);
+    syncDirectoryOf(journalFile);
+    syncedBytes = header.size() + records.size();
+}
+
+std::vector<TestAttempt> AttemptJournal::recover(size_t snapshotAttempts) {
+    closeFile();
+    pending.clear();
+    pendingRecords = 0;
+    journalRecords = 0;
+
+    std::string data;
+    {
+        std::ifstream in(journalFile, std::ios::binary);
+        if (in) {
+            data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+    }
+
+    // A missing journal, or one that crashed before its header was
+    // complete, extends the snapshot as it is
+    std::vector<TestAttempt> recovered;
+    if (data.size() < kHeaderBytes ||
+        std::memcmp(data.data(), kJournalMagic, sizeof(kJournalMagic)) != 0) {
+        writeJournal(snapshotAttempts);
+        baseAttempts = snapshotAttempts;
+        openForAppend();
+        return recovered;
+    }
+
+    baseAttempts = getU64(data.data() + sizeof(kJournalMagic));
+    if (snapshotAttempts < baseAttempts) {
+        throw AttemptJournalException("Journal " + journalFile + " extends " +
+                                      std::to_string(baseAttempts) + " attempts but the snapshot has " +
+                                      std::to_string(snapshotAttempts));
+    }
+    // Records a compaction already folded into the snapshot before the
+    // crash kept it from starting a new journal
+    const std::uint64_t alreadySaved = snapshotAttempts - baseAttempts;
+
+    size_t offset = kHeaderBytes;
+    size_t firstRecovered = offset;
+    std::vector<std::string> answers;
+    double percentage = 0.0;
+    while (data.size() - offset >= kRecordHeaderBytes) {
+        const std::uint32_t length = getU32(data.data() + offset);
+        const std::uint32_t checksum = getU32(data.data() + offset + 4);
+        const char* payload = data.data() + offset + kRecordHeaderBytes;
+        if (length > kMaxPayloadBytes || data.size() - offset - kRecordHeaderBytes < length ||
+            crc32(payload, length) != checksum ||
+            !decodePayload(payload, length, answers, percentage)) {
+            break;
+        }
+        if (++journalRecords > alreadySaved) {
+            recovered.emplace_back(std::move(answers), percentage);
+            answers = std::vector<std::string>();
+        }
+        offset += kRecordHeaderBytes + length;
+        if (journalRecords == alreadySaved) {
+            firstRecovered = offset;
+        }
+    }
+    if (alreadySaved > journalRecords) {
+        throw AttemptJournalException("Snapshot has " + std::to_string(snapshotAttempts) +
+                                      " attempts but journal " + journalFile + " reaches only " +
+                                      std::to_string(baseAttempts + journalRecords));
+    }
+
+    syncedBytes = offset;
+    if (alreadySaved > 0) {
+        // Restart the journal at the snapshot, so the records it already
+        // holds can never be counted against later ones
+        writeJournal(snapshotAttempts, data.substr(firstRecovered, offset - firstRecovered));
+        baseAttempts = snapshotAttempts;
+        journalRecords = recovered.size();
+    } else if (offset < data.size()) {
+        std::error_code error;
+        std::filesystem::resize_file(journalFile, offset, error);
+        if (error) {
+            throw AttemptJournalException("Cannot cut torn records from " + journalFile + ": " +
+                                          error.message());
+        }
+        syncPath(journalFile);
+    }
+    openForAppend();
+    return recovered;
+}
+
+void AttemptJournal::append(const AttemptStore& store, size_t attempt) {
+    if (!file) {
+        throw AttemptJournalException("Journal must be recovered before appending: " + journalFile);
+    }
+    const size_t start = pending.size();
+    pending.append(kRecordHeaderBytes, '\0');
+
+    std::uint64_t bits;
+    const double percentage = store.percentage(attempt);
+    std::memcpy(&bits, &percentage, sizeof(bits));
+    putU64(pending, bits);
+    putU32(pending, static_cast<std::uint32_t>(store.numQuestions()));
+    for (size_t q = 0; q < store.numQuestions(); ++q) {
+        const std::string& answer = store.answerText(q, store.answerId(q, attempt));
+        putU32(pending, static_cast<std::uint32_t>(answer.size()));
+        pending += answer;
+    }
+
+    const size_t length = pending.size() - start - kRecordHeaderBytes;
+    storeU32(&pending[start], static_cast<std::uint32_t>(length));
+    storeU32(&pending[start + 4], crc32(pending.data() + start + kRecordHeaderBytes, length));
+    pendingRecords++;
+    journalRecords++;
+    if (pendingRecords >= options.syncEvery) {
+        sync();
+    }
+}
+
+void AttemptJournal::sync() {
+    if (pending.empty() || !file) {
+        return;
+    }
+    bool written = std::fwrite(pending.data(), 1, pending.size(), file) == pending.size() &&
+                   std::fflush(file) == 0;
+#ifdef ATTEMPT_JOURNAL_FSYNC
+#if defined(__APPLE__)
+    written = written && ::fsync(fileno(file)) == 0;
+#else
+    written = written && ::fdatasync(fileno(file)) == 0;
+#endif
+#endif
+    if (!written) {
+        // Cut off whatever part of the batch reached the file, so a retry
+        // writes it again after the last good record. If the journal cannot
+        // be cut and reopened, appends fail until it is recovered.
+        closeFile();
+        std::error_code error;
+        std::filesystem::resize_file(journalFile, syncedBytes, error);
+        if (!error) {
+            file = std::fopen(journalFile.c_str(), "ab");
+        }
+        throw AttemptJournalException("Error writing to journal: " + journalFile);
+    }
+    syncedBytes += pending.size();
+    pending.clear();
+    pendingRecords = 0;
+}
+
+void AttemptJournal::commitSnapshot(const std::string& tempPath, size_t attempts) {
+    // Everything the snapshot holds must be durable in the journal before
+    // the snapshot replaces the old one
+    sync();
+    syncPath(tempPath);
+    renameFile(tempPath, snapshotFile);
+    syncDirectoryOf(snapshotFile);
+
+    closeFile();
+    writeJournal(attempts);
+    baseAttempts = attempts;
+    journalRecords = 0;
+    openForAppend();
+}
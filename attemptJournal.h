@@ -0,0 +1,84 @@
+#ifndef ATTEMPT_JOURNAL_H
+#define ATTEMPT_JOURNAL_H
+
+#include "answerAnalyzer.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Custom exception class for AttemptJournal-specific errors
+class AttemptJournalException : public std::runtime_error {
+public:
+    explicit AttemptJournalException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+struct JournalOptions {
+    size_t syncEvery = 64;         // records per write and fsync; 1 = every record
+    size_t compactAfter = 100000;  // journal records that trigger a new snapshot; 0 = never
+};
+
+// Write-ahead journal for an analyzer's attempts, next to a binary snapshot
+// of the history. The snapshot lives at the given path and the journal at
+// path + ".journal":
+//
+//   header:  8-byte magic, u64 attempts in the snapshot it extends
+//   record:  u32 payload length, u32 CRC-32 of the payload, payload
+//   payload: f64 percentage, u32 answer count, per answer u32 length + bytes
+//
+// Records are buffered and written with one fsync per syncEvery records, so
+// a crash loses at most the unsynced ones. Recovery stops at the first
+// torn or corrupt record and cuts the file there. Compaction writes a new
+// snapshot and an empty journal, each to a temporary file that is synced
+// and renamed into place; if a crash leaves a new snapshot with the old
+// journal, the header's attempt count tells which records the snapshot
+// already holds, and recovery rewrites the journal without them. A failed
+// write is cut back off the journal, keeping the records pending.
+class AttemptJournal {
+private:
+    JournalOptions options;
+    std::string snapshotFile;
+    std::string journalFile;
+    std::FILE* file;            // journal, opened for appending
+    std::string pending;        // encoded records not yet written
+    size_t pendingRecords;
+    size_t journalRecords;      // records in the journal, written or not
+    std::uint64_t baseAttempts; // snapshot size the journal extends
+    std::uint64_t syncedBytes;  // journal length up to the last synced record
+
+    void openForAppend();
+    void closeFile();
+    void writeJournal(std::uint64_t attempts, const std::string& records = std::string());
+
+public:
+    AttemptJournal(const std::string& snapshotPath, const JournalOptions& journalOptions = JournalOptions());
+    ~AttemptJournal();
+
+    AttemptJournal(const AttemptJournal&) = delete;
+    AttemptJournal& operator=(const AttemptJournal&) = delete;
+
+    // Core functionality
+    // Attempts recorded after the first snapshotAttempts, in order. A torn
+    // tail is cut off so that appends continue from the last good record.
+    std::vector<TestAttempt> recover(size_t snapshotAttempts);
+    void append(const AttemptStore& store, size_t attempt);
+    void sync();  // write and fsync the buffered records
+    // Replace the snapshot with the one written to tempPath, holding
+    // attempts attempts, and start an empty journal after it
+    void commitSnapshot(const std::string& tempPath, size_t attempts);
+    bool needsCompaction() const {
+        return options.compactAfter > 0 && journalRecords >= options.compactAfter;
+    }
+
+    // Getters
+    const std::string& getSnapshotPath() const { return snapshotFile; }
+    const std::string& getJournalPath() const { return journalFile; }
+    size_t getJournalRecords() const { return journalRecords; }
+    size_t getPendingRecords() const { return pendingRecords; }
+    const JournalOptions& getOptions() const { return options; }
+};
+
+#endif
@@ -0,0 +1,409 @@
+#include "attemptStore.h"
+#include "mappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <utility>
+
+const AttemptStore::AnswerId AttemptStore::kNoAnswer;
+const std::uint32_t AttemptStore::kBinaryVersion;
+
+namespace {
+
+// Binary file layout, all integers in the writer's byte order:
+//
+//   BinaryHeader
+//   string table   per question: u32 answer count, then per answer id
+//                  u32 byte length and the answer text
+//   answer matrix  u16 ids, question by question, attemptCount per question
+//   scores         f64 percentage per attempt
+//
+// The matrix and the scores start on 8-byte boundaries so they can be used
+// in place once the file is mapped.
+struct BinaryHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;   // kByteOrderMark as written
+    std::uint64_t questionCount;
+    std::uint64_t attemptCount;
+    std::uint64_t stringTableOffset;
+    std::uint64_t matrixOffset;
+    std::uint64_t scoresOffset;
+    std::uint64_t fileSize;
+};
+
+const char kBinaryMagic[8] = {'A', 'N', 'S', 'W', 'R', 'B', 'I', 'N'};
+const std::uint32_t kByteOrderMark = 0x01020304;
+
+size_t alignTo8(size_t offset) {
+    return (offset + 7) & ~size_t(7);
+}
+
+void writeBytes(std::ostream& out, const void* data, size_t size) {
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+}
+
+void writeU32(std::ostream& out, std::uint32_t value) {
+    writeBytes(out, &value, sizeof(value));
+}
+
+void writePadding(std::ostream& out, size_t from, size_t to) {
+    static const char zeros[8] = {};
+    writeBytes(out, zeros, to - from);
+}
+
+// Bounds-checked reader over the mapped string table
+class TableReader {
+private:
+    const char* data;
+    size_t position;
+    size_t end;
+
+public:
+    TableReader(const char* bytes, size_t begin, size_t limit)
+        : data(bytes), position(begin), end(limit) {}
+
+    std::uint32_t readU32() {
+        if (end - position < sizeof(std::uint32_t)) {
+            throw AttemptStoreException("Truncated string table in binary file");
+        }
+        std::uint32_t value;
+        std::memcpy(&value, data + position, sizeof(value));
+        position += sizeof(value);
+        return value;
+    }
+
+    std::string readString() {
+        std::uint32_t length = readU32();
+        if (end - position < length) {
+            throw AttemptStoreException("Truncated string table in binary file");
+        }
+        std::string text(data + position, length);
+        position += length;
+        return text;
+    }
+};
+
+}  // namespace
+
+AttemptStore::AttemptStore(const AttemptStore& other)
+    : questionCount(other.questionCount), attemptCount(other.attemptCount),
+      capacity(other.capacity), cells(other.cells), percentages(other.percentages),
+      mapping(other.mapping), retaining(other.retaining), latestIds(other.latestIds),
+      dictionaries(other.dictionaries) {
+    // A mapped store shares the mapping; an owned one points at its own copy
+    cellBase = mapping ? other.cellBase : cells.data();
+    percentageBase = mapping ? other.percentageBase : percentages.data();
+
+    // The id -> text table points into the dictionaries, so rebuild it
+    answerTexts.resize(dictionaries.size());
+    for (size_t q = 0; q < dictionaries.size(); ++q) {
+        answerTexts[q].resize(dictionaries[q].size());
+        for (const auto& [answer, id] : dictionaries[q]) {
+            answerTexts[q][id] = &answer;
+        }
+    }
+}
+
+AttemptStore& AttemptStore::operator=(const AttemptStore& other) {
+    if (this != &other) {
+        AttemptStore copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+// Validate an attempt and make room for it. Every dictionary is checked
+// first so a rejected attempt leaves no trace.
+void AttemptStore::beginAdd(const std::vector<std::string>& answers) {
+    if (attemptCount == 0) {
+        questionCount = answers.size();
+        dictionaries.assign(questionCount, {});
+        answerTexts.assign(questionCount, {});
+    } else if (answers.size() != questionCount) {
+        throw AttemptStoreException("Number of answers must match previous attempts");
+    }
+
+    for (size_t q = 0; q < questionCount; ++q) {
+        if (answerTexts[q].size() >= kNoAnswer && !dictionaries[q].count(answers[q])) {
+            throw AttemptStoreException("Too many distinct answers for question " +
+                                        std::to_string(q + 1));
+        }
+    }
+
+    if (mapping) {
+        detachMapping();
+    }
+    if (retaining && attemptCount == capacity) {
+        reserveColumns(std::max<size_t>(16, capacity * 2));
+    }
+    latestIds.resize(questionCount);
+}
+
+// Id of an answer, adding it to the question's dictionary on first sight.
+// try_emplace only builds a node, and only moves the answer, when it is new.
+template <typename Answer>
+AttemptStore::AnswerId AttemptStore::intern(size_t q, Answer&& answer) {
+    auto [entry, inserted] = dictionaries[q].try_emplace(
+        std::forward<Answer>(answer), static_cast<AnswerId>(answerTexts[q].size()));
+    if (inserted) {
+        answerTexts[q].push_back(&entry->first);
+    }
+    return entry->second;
+}
+
+// Store the ids in latestIds and the score
+void AttemptStore::finishAdd(double percentage) {
+    if (retaining) {
+        for (size_t q = 0; q < questionCount; ++q) {
+            cells[q * capacity + attemptCount] = latestIds[q];
+        }
+        percentages.push_back(percentage);
+        percentageBase = percentages.data();
+    }
+    attemptCount++;
+}
+
+void AttemptStore::add(const std::vector<std::string>& answers, double percentage) {
+    beginAdd(answers);
+    for (size_t q = 0; q < questionCount; ++q) {
+        latestIds[q] = intern(q, answers[q]);
+    }
+    finishAdd(percentage);
+}
+
+void AttemptStore::add(std::vector<std::string>&& answers, double percentage) {
+    beginAdd(answers);
+    for (size_t q = 0; q < questionCount; ++q) {
+        latestIds[q] = intern(q, std::move(answers[q]));
+    }
+    finishAdd(percentage);
+}
+
+void AttemptStore::reserve(size_t totalAttempts) {
+    if (attemptCount == 0) {
+        throw AttemptStoreException("Cannot reserve before the number of questions is known");
+    }
+    if (!retaining || totalAttempts <= capacity) {
+        return;
+    }
+    if (mapping) {
+        detachMapping();
+    }
+    reserveColumns(totalAttempts);
+    percentages.reserve(totalAttempts);
+    percentageBase = percentages.data();
+}
+
+void AttemptStore::clear() {
+    questionCount = 0;
+    attemptCount = 0;
+    capacity = 0;
+    cells.clear();
+    percentages.clear();
+    mapping.reset();
+    cellBase = nullptr;
+    percentageBase = nullptr;
+    retaining = true;
+    latestIds.clear();
+    dictionaries.clear();
+    answerTexts.clear();
+}
+
+void AttemptStore::setRetainAttempts(bool retain) {
+    if (attemptCount != 0) {
+        throw AttemptStoreException("Retention can only change while the store is empty");
+    }
+    retaining = retain;
+}
+
+void AttemptStore::discardAttempts() {
+    std::vector<AnswerId>().swap(cells);
+    std::vector<double>().swap(percentages);
+    mapping.reset();
+    cellBase = nullptr;
+    percentageBase = nullptr;
+    capacity = 0;
+    retaining = false;
+}
+
+// Grow every column to newCapacity attempts, keeping the matrix contiguous
+void AttemptStore::reserveColumns(size_t newCapacity) {
+    std::vector<AnswerId> grown(questionCount * newCapacity);
+    for (size_t q = 0; q < questionCount; ++q) {
+        std::copy(column(q), column(q) + attemptCount, grown.begin() + q * newCapacity);
+    }
+    cells.swap(grown);
+    cellBase = cells.data();
+    capacity = newCapacity;
+}
+
+// Copy a mapped matrix and score column into owned buffers before mutating
+void AttemptStore::detachMapping() {
+    cells.assign(cellBase, cellBase + questionCount * capacity);
+    percentages.assign(percentageBase, percentageBase + attemptCount);
+    cellBase = cells.data();
+    percentageBase = percentages.data();
+    mapping.reset();
+}
+
+AttemptStore::AnswerId AttemptStore::findAnswer(size_t q, const std::string& answer) const {
+    if (q >= questionCount) {
+        return kNoAnswer;
+    }
+    auto it = dictionaries[q].find(answer);
+    return it == dictionaries[q].end() ? kNoAnswer : it->second;
+}
+
+std::vector<std::string> AttemptStore::answers(size_t attempt) const {
+    std::vector<std::string> result;
+    result.reserve(questionCount);
+    for (size_t q = 0; q < questionCount; ++q) {
+        result.push_back(answerText(q, answerId(q, attempt)));
+    }
+    return result;
+}
+
+size_t AttemptStore::memoryUsage() const {
+    size_t bytes = cells.capacity() * sizeof(AnswerId) + percentages.capacity() * sizeof(double);
+    for (size_t q = 0; q < questionCount; ++q) {
+        // Map nodes carry roughly four pointers of overhead
+        for (const auto& [answer, id] : dictionaries[q]) {
+            bytes += sizeof(std::string) + answer.capacity() + sizeof(AnswerId) + 4 * sizeof(void*);
+        }
+        bytes += answerTexts[q].capacity() * sizeof(const std::string*);
+    }
+    return bytes;
+}
+
+bool AttemptStore::isBinaryFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(kBinaryMagic)];
+    return file.read(magic, sizeof(magic)) &&
+           std::memcmp(magic, kBinaryMagic, sizeof(magic)) == 0;
+}
+
+void AttemptStore::writeBinary(std::ostream& out) const {
+    if (!retaining && attemptCount > 0) {
+        throw AttemptStoreException("A summary-only store has no attempts to write");
+    }
+    BinaryHeader header;
+    std::memcpy(header.magic, kBinaryMagic, sizeof(header.magic));
+    header.version = kBinaryVersion;
+    header.byteOrder = kByteOrderMark;
+    header.questionCount = questionCount;
+    header.attemptCount = attemptCount;
+    header.stringTableOffset = sizeof(BinaryHeader);
+
+    size_t tableSize = 0;
+    for (size_t q = 0; q < questionCount; ++q) {
+        tableSize += sizeof(std::uint32_t);
+        for (const std::string* answer : answerTexts[q]) {
+            tableSize += sizeof(std::uint32_t) + answer->size();
+        }
+    }
+    size_t tableEnd = sizeof(BinaryHeader) + tableSize;
+    header.matrixOffset = alignTo8(tableEnd);
+    size_t matrixEnd = header.matrixOffset + questionCount * attemptCount * sizeof(AnswerId);
+    header.scoresOffset = alignTo8(matrixEnd);
+    header.fileSize = header.scoresOffset + attemptCount * sizeof(double);
+
+    writeBytes(out, &header, sizeof(header));
+    for (size_t q = 0; q < questionCount; ++q) {
+        writeU32(out, static_cast<std::uint32_t>(answerTexts[q].size()));
+        for (const std::string* answer : answerTexts[q]) {
+            writeU32(out, static_cast<std::uint32_t>(answer->size()));
+            writeBytes(out, answer->data(), answer->size());
+        }
+    }
+    writePadding(out, tableEnd, header.matrixOffset);
+    // Columns are already contiguous; only the unused capacity is skipped
+    for (size_t q = 0; q < questionCount; ++q) {
+        writeBytes(out, column(q), attemptCount * sizeof(AnswerId));
+    }
+    writePadding(out, matrixEnd, header.scoresOffset);
+    writeBytes(out, percentageBase, attemptCount * sizeof(double));
+}
+
+AttemptStore AttemptStore::mapBinary(const std::string& filename) {
+    std::shared_ptr<const MappedFile> file;
+    try {
+        file = std::make_shared<const MappedFile>(filename);
+    } catch (const MappedFileException& e) {
+        throw AttemptStoreException(e.what());
+    }
+    const char* data = file->data();
+
+    BinaryHeader header;
+    if (file->size() < sizeof(header)) {
+        throw AttemptStoreException("Not an attempt file: " + filename);
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kBinaryMagic, sizeof(header.magic)) != 0) {
+        throw AttemptStoreException("Not an attempt file: " + filename);
+    }
+    if (header.byteOrder != kByteOrderMark) {
+        throw AttemptStoreException("Attempt file was written with a different byte order: " + filename);
+    }
+    if (header.version != kBinaryVersion) {
+        throw AttemptStoreException("Unsupported attempt file version " +
+                                    std::to_string(header.version) + ": " + filename);
+    }
+
+    // Every section must fit, in order, inside the file
+    const std::uint64_t cellCount = header.questionCount * header.attemptCount;
+    if (header.fileSize != file->size() ||
+        (header.questionCount != 0 && cellCount / header.questionCount != header.attemptCount) ||
+        header.stringTableOffset < sizeof(header) ||
+        header.matrixOffset < header.stringTableOffset || header.matrixOffset % 8 != 0 ||
+        header.scoresOffset % 8 != 0 ||
+        header.matrixOffset > header.fileSize || header.scoresOffset > header.fileSize ||
+        cellCount > (header.fileSize - header.matrixOffset) / sizeof(AnswerId) ||
+        header.scoresOffset < header.matrixOffset + cellCount * sizeof(AnswerId) ||
+        header.attemptCount > (header.fileSize - header.scoresOffset) / sizeof(double)) {
+        throw AttemptStoreException("Corrupt attempt file: " + filename);
+    }
+
+    AttemptStore store;
+    store.questionCount = header.questionCount;
+    store.attemptCount = header.attemptCount;
+    store.capacity = header.attemptCount;
+    store.dictionaries.assign(store.questionCount, {});
+    store.answerTexts.assign(store.questionCount, {});
+
+    // Only the dictionaries are rebuilt; they are small next to the matrix
+    TableReader table(data, header.stringTableOffset, header.matrixOffset);
+    for (size_t q = 0; q < store.questionCount; ++q) {
+        std::uint32_t count = table.readU32();
+        if (count >= kNoAnswer) {
+            throw AttemptStoreException("Too many distinct answers for question " +
+                                        std::to_string(q + 1));
+        }
+        store.answerTexts[q].reserve(count);
+        for (std::uint32_t id = 0; id < count; ++id) {
+            auto [entry, inserted] = store.dictionaries[q].emplace(
+                table.readString(), static_cast<AnswerId>(id));
+            if (!inserted) {
+                throw AttemptStoreException("Corrupt attempt file: " + filename);
+            }
+            store.answerTexts[q].push_back(&entry->first);
+        }
+    }
+
+    store.cellBase = reinterpret_cast<const AnswerId*>(data + header.matrixOffset);
+    store.percentageBase = reinterpret_cast<const double*>(data + header.scoresOffset);
+    store.mapping = std::move(file);
+
+    // One linear pass keeps later lookups by id in bounds
+    for (size_t q = 0; q < store.questionCount; ++q) {
+        const AnswerId* ids = store.column(q);
+        const AnswerId limit = static_cast<AnswerId>(store.answerTexts[q].size());
+        for (size_t i = 0; i < store.attemptCount; ++i) {
+            if (ids[i] >= limit) {
+                throw AttemptStoreException("Corrupt attempt file: " + filename);
+            }
+        }
+    }
+    return store;
+}
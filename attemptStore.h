@@ -0,0 +1,113 @@
+#ifndef ATTEMPT_STORE_H
+#define ATTEMPT_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Custom exception class for AttemptStore-specific errors
+class AttemptStoreException : public std::runtime_error {
+public:
+    explicit AttemptStoreException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+class MappedFile;
+
+// Column-major storage for test attempts. Every question keeps a dictionary
+// that interns its answers into small integer ids, and the ids live in one
+// contiguous matrix laid out question by question, so scanning a question
+// across all attempts is a linear walk over 16-bit integers.
+//
+// The matrix and scores can also live in a memory-mapped binary file (see
+// writeBinary for the layout). Such a store reads straight from the
+// mapping and only copies it into its own buffers when an attempt is added.
+//
+// A store can also be summary-only: it still interns answers and counts
+// attempts, but keeps no matrix or scores, so its memory is bounded by the
+// number of distinct answers however many attempts pass through it.
+class AttemptStore {
+public:
+    typedef std::uint16_t AnswerId;
+
+    // Returned by findAnswer for answers never recorded; also bounds the
+    // number of distinct answers per question
+    static const AnswerId kNoAnswer = 0xFFFF;
+
+private:
+    size_t questionCount;
+    size_t attemptCount;
+    size_t capacity;                   // attempts each column has room for
+    std::vector<AnswerId> cells;       // cells[q * capacity + i]
+    std::vector<double> percentages;
+    std::shared_ptr<const MappedFile> mapping;  // set while reading from a binary file
+    const AnswerId* cellBase;          // cells.data(), or the mapped matrix
+    const double* percentageBase;      // percentages.data(), or the mapped scores
+    bool retaining;                    // false once the store is summary-only
+    std::vector<AnswerId> latestIds;   // ids of the most recently added attempt
+
+    std::vector<std::map<std::string, AnswerId>> dictionaries;  // answer -> id, per question
+    std::vector<std::vector<const std::string*>> answerTexts;   // id -> dictionary key
+
+    void reserveColumns(size_t newCapacity);
+    void detachMapping();
+    void beginAdd(const std::vector<std::string>& answers);
+    void finishAdd(double percentage);
+    template <typename Answer>
+    AnswerId intern(size_t q, Answer&& answer);
+
+public:
+    // Version written to and accepted from binary files
+    static const std::uint32_t kBinaryVersion = 1;
+
+    AttemptStore()
+        : questionCount(0), attemptCount(0), capacity(0),
+          cellBase(nullptr), percentageBase(nullptr), retaining(true) {}
+    AttemptStore(const AttemptStore& other);
+    AttemptStore& operator=(const AttemptStore& other);
+    AttemptStore(AttemptStore&&) = default;
+    AttemptStore& operator=(AttemptStore&&) = default;
+
+    // Core functionality
+    void add(const std::vector<std::string>& answers, double percentage);
+    void add(std::vector<std::string>&& answers, double percentage);  // moves new answers in
+    void reserve(size_t totalAttempts);  // room for this many; needs at least one attempt
+    void clear();
+    void setRetainAttempts(bool retain);  // only while empty
+    void discardAttempts();               // keep the dictionaries and count, drop the rest
+
+    // Getters
+    size_t size() const { return attemptCount; }
+    bool empty() const { return attemptCount == 0; }
+    size_t numQuestions() const { return questionCount; }
+    double percentage(size_t attempt) const { return percentageBase[attempt]; }
+    AnswerId answerId(size_t q, size_t attempt) const { return cellBase[q * capacity + attempt]; }
+    const AnswerId* column(size_t q) const { return cellBase + q * capacity; }
+    bool isMapped() const { return mapping != nullptr; }
+    bool retainsAttempts() const { return retaining; }
+    const std::vector<AnswerId>& latestAnswerIds() const { return latestIds; }
+
+    // Dictionary access
+    size_t numAnswers(size_t q) const { return answerTexts[q].size(); }
+    const std::string& answerText(size_t q, AnswerId id) const { return *answerTexts[q][id]; }
+    AnswerId findAnswer(size_t q, const std::string& answer) const;
+    const std::map<std::string, AnswerId>& dictionary(size_t q) const { return dictionaries[q]; }
+
+    // Rebuild the answer strings of one attempt; needs a retaining store
+    std::vector<std::string> answers(size_t attempt) const;
+
+    // Approximate heap footprint in bytes; a mapped matrix is not counted
+    size_t memoryUsage() const;
+
+    // Binary files
+    static bool isBinaryFile(const std::string& filename);
+    static AttemptStore mapBinary(const std::string& filename);
+    void writeBinary(std::ostream& out) const;
+};
+
+#endif
@@ -0,0 +1,547 @@
+#include "batchCli.h"
+#include "analysisServer.h"
+#include "answerAnalyzer.h"
+#include "bulkGrader.h"
+#include "emScorer.h"
+#include "jsonWriter.h"
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+
+namespace {
+
+enum class BatchCommand { Analyze, Suggest, Predict, Stats, Convert, Grade };
+
+struct BatchOptions {
+    BatchCommand command = BatchCommand::Stats;
+    std::vector<std::string> files;
+    std::vector<std::string> sheet;   // predict, and the key for grade
+    size_t threads = 1;
+    size_t maxQuestions = 10;
+    bool stream = false;              // stats only
+    FileFormat convertFormat = FileFormat::Binary;
+    SuggestionOptions suggestion;
+    bool timing = false;
+    bool profile = false;
+    bool emScorer = false;
+    std::optional<size_t> fuzzyEdits;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+size_t parseCount(const std::string& option, const std::string& value) {
+    try {
+        size_t used = 0;
+        unsigned long long parsed = std::stoull(value, &used);
+        if (used == value.size()) {
+            return static_cast<size_t>(parsed);
+        }
+    } catch (const std::exception&) {
+    }
+    throw BatchCliException("Invalid value for " + option + ": " + value);
+}
+
+std::vector<std::string> splitSheet(const std::string& sheet) {
+    std::vector<std::string> answers;
+    std::stringstream stream(sheet);
+    std::string answer;
+    while (std::getline(stream, answer, ',')) {
+        answers.push_back(answer);
+    }
+    if (!sheet.empty() && sheet.back() == ',') {
+        answers.push_back("");
+    }
+    return answers;
+}
+
+void readFileList(const std::string& path, std::vector<std::string>& files) {
+    std::ifstream listFile;
+    if (path != "-") {
+        listFile.open(path);
+        if (!listFile) {
+            throw BatchCliException("Cannot open file list: " + path);
+        }
+    }
+    std::istream& list = path == "-" ? std::cin : listFile;
+    std::string line;
+    while (std::getline(list, line)) {
+        if (!line.empty()) {
+            files.push_back(line);
+        }
+    }
+}
+
+BatchOptions parseArguments(const std::vector<std::string>& args) {
+    if (args.empty()) {
+        throw BatchCliException("Missing command");
+    }
+
+    BatchOptions options;
+    const std::string& command = args[0];
+    if (command == "analyze") {
+        options.command = BatchCommand::Analyze;
+    } else if (command == "suggest") {
+        options.command = BatchCommand::Suggest;
+    } else if (command == "predict") {
+        options.command = BatchCommand::Predict;
+    } else if (command == "stats") {
+        options.command = BatchCommand::Stats;
+    } else if (command == "convert") {
+        options.command = BatchCommand::Convert;
+    } else if (command == "grade") {
+        options.command = BatchCommand::Grade;
+    } else {
+        throw BatchCliException("Unknown command: " + command);
+    }
+
+    std::vector<std::string> positional;
+    for (size_t i = 1; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        auto value = [&]() -> const std::string& {
+            if (i + 1 >= args.size()) {
+                throw BatchCliException("Missing value for " + arg);
+            }
+            return args[++i];
+        };
+
+        if (arg == "--threads") {
+            options.threads = parseCount(arg, value());
+        } else if (arg == "--max-questions") {
+            options.maxQuestions = parseCount(arg, value());
+        } else if (arg == "--iterations") {
+            options.suggestion.maxIterations = parseCount(arg, value());
+        } else if (arg == "--seed") {
+            options.suggestion.seed = static_cast<std::uint32_t>(parseCount(arg, value()));
+        } else if (arg == "--files-from") {
+            readFileList(value(), options.files);
+        } else if (arg == "--stream") {
+            options.stream = true;
+        } else if (arg == "--binary") {
+            options.convertFormat = FileFormat::Binary;
+        } else if (arg == "--text") {
+            options.convertFormat = FileFormat::Text;
+        } else if (arg == "--compressed") {
+            options.convertFormat = FileFormat::Compressed;
+        } else if (arg == "--timing") {
+            options.timing = true;
+        } else if (arg == "--profile") {
+            options.profile = true;
+        } else if (arg == "--fuzzy") {
+            options.fuzzyEdits = parseCount(arg, value());
+        } else if (arg == "--scorer") {
+            const std::string& scorer = value();
+            if (scorer != "heuristic" && scorer != "em") {
+                throw BatchCliException("Invalid value for --scorer: " + scorer);
+            }
+            options.emScorer = scorer == "em";
+        } else if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+            throw BatchCliException("Unknown option: " + arg);
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    size_t first = 0;
+    if (options.command == BatchCommand::Predict || options.command == BatchCommand::Grade) {
+        if (positional.empty()) {
+            throw BatchCliException(args[0] + (options.command == BatchCommand::Grade
+                                                   ? " needs an answer key"
+                                                   : " needs an answer sheet"));
+        }
+        options.sheet = splitSheet(positional[0]);
+        first = 1;
+    }
+    options.files.insert(options.files.begin(), positional.begin() + first, positional.end());
+
+    if (options.files.empty()) {
+        throw BatchCliException("No input files");
+    }
+    if ((options.command == BatchCommand::Convert || options.command == BatchCommand::Grade) &&
+        options.files.size() % 2 != 0) {
+        throw BatchCliException(args[0] + " takes pairs of input and output files");
+    }
+    if (options.stream && options.command != BatchCommand::Stats) {
+        throw BatchCliException("--stream only applies to stats");
+    }
+    return options;
+}
+
+// Options shared by serve and loadgen
+struct ServerCommandOptions {
+    ServerOptions server;
+    LoadOptions load;
+};
+
+ServerCommandOptions parseServerArguments(const std::vector<std::string>& args) {
+    const bool serving = args[0] == "serve";
+    ServerCommandOptions options;
+    std::vector<std::string> positional;
+    for (size_t i = 1; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        auto value = [&]() -> const std::string& {
+            if (i + 1 >= args.size()) {
+                throw BatchCliException("Missing value for " + arg);
+            }
+            return args[++i];
+        };
+
+        if (arg == "--socket") {
+            options.server.address.socketPath = value();
+        } else if (arg == "--port") {
+            options.server.address.tcpPort = static_cast<int>(parseCount(arg, value()));
+        } else if (serving && arg == "--threads") {
+            options.server.threads = parseCount(arg, value());
+        } else if (serving && arg == "--max-questions") {
+            options.server.maxQuestions = parseCount(arg, value());
+        } else if (serving && arg == "--data-dir") {
+            options.server.dataDirectory = value();
+        } else if (serving && arg == "--batch-window") {
+            options.server.batchWindowUs = static_cast<int>(parseCount(arg, value()));
+        } else if (!serving && arg == "--clients") {
+            options.load.clients = parseCount(arg, value());
+        } else if (!serving && arg == "--requests") {
+            options.load.requestsPerClient = parseCount(arg, value());
+        } else if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+            throw BatchCliException("Unknown option: " + arg);
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    const ServerAddress& address = options.server.address;
+    if (address.socketPath.empty() == (address.tcpPort == 0)) {
+        throw BatchCliException(args[0] + " needs exactly one of --socket and --port");
+    }
+    if (positional.size() > 1) {
+        throw BatchCliException("Too many arguments for " + args[0]);
+    }
+    if (serving) {
+        options.server.loadFile = positional.empty() ? "" : positional[0];
+    } else {
+        if (positional.empty()) {
+            throw BatchCliException("loadgen needs an answer sheet");
+        }
+        options.load.address = address;
+        options.load.sheet = splitSheet(positional[0]);
+    }
+    return options;
+}
+
+// The server being run by serve, for the signal handler
+AnalysisServer* activeServer = nullptr;
+
+extern "C" void stopActiveServer(int) {
+    if (activeServer) {
+        activeServer->stop();
+    }
+}
+
+int runServerCommand(const std::vector<std::string>& args, std::ostream& out, std::ostream& err) {
+    ServerCommandOptions options;
+    try {
+        options = parseServerArguments(args);
+    } catch (const BatchCliException& e) {
+        err << "Error: " << e.what() << "\n";
+        printBatchUsage(err);
+        return 2;
+    }
+
+    try {
+        if (args[0] == "loadgen") {
+            LoadReport report = runLoadGenerator(options.load);
+            out << std::fixed << std::setprecision(3)
+                << "{\"requests\":" << report.requests << ",\"errors\":" << report.errors
+                << ",\"seconds\":" << report.seconds << ",\"throughput\":" << report.throughput
+                << ",\"p50_us\":" << report.p50Us << ",\"p99_us\":" << report.p99Us
+                << ",\"max_us\":" << report.maxUs << "}" << std::endl;
+            return report.errors > 0 ? 1 : 0;
+        }
+
+        AnalysisServer server(options.server);
+        server.listen();
+        activeServer = &server;
+        std::signal(SIGINT, stopActiveServer);
+        std::signal(SIGTERM, stopActiveServer);
+        err << "Listening; stop with Ctrl-C" << std::endl;
+        server.run();
+        activeServer = nullptr;
+        std::signal(SIGINT, SIG_DFL);
+        std::signal(SIGTERM, SIG_DFL);
+        out << "{\"batches\":" << server.getBatchCount()
+            << ",\"batched_predicts\":" << server.getBatchedPredicts() << "}" << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        activeServer = nullptr;
+        err << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+// Grade a file of sheets, one comma-separated sheet per line, and write
+// the graded sheets as an attempt file for the other commands
+void gradeFile(const BatchOptions& options, BulkGrader& grader, const std::string& input,
+               const std::string& output, std::ostream& record) {
+    std::ifstream sheets(input);
+    if (!sheets) {
+        throw BatchCliException("Cannot open file for reading: " + input);
+    }
+    AnswerAnalyzer graded(grader.getNumQuestions());
+    grader.resetStats();
+    grader.gradeStream(sheets, [&](std::vector<TestAttempt>& chunk) {
+        graded.addAttempts(std::move(chunk));
+    });
+    if (sheets.bad()) {
+        throw BatchCliException("Error reading from file: " + input);
+    }
+    graded.saveToFile(output, options.convertFormat);
+
+    const GradingStats& stats = grader.getStats();
+    record << ",\"output\":";
+    writeJsonString(record, output);
+    record << ",\"sheets\":" << stats.sheets << ",\"rejected\":" << stats.rejected;
+    if (stats.rejected > 0) {
+        record << ",\"first_error\":";
+        writeJsonString(record, stats.firstError);
+    }
+    record << ",\"average\":" << graded.getAverageScore()
+           << ",\"sheets_per_s\":" << stats.sheetsPerSecond();
+}
+
+// One JSON line with the per-method counters gathered during the run
+void writeProfile(std::ostream& err) {
+    err << std::fixed << std::setprecision(3) << "{\"profile\":[";
+    bool first = true;
+    for (const MethodMetrics& method : AnswerAnalyzer::getMetrics()) {
+        err << (first ? "" : ",") << "{\"method\":";
+        writeJsonString(err, method.method);
+        err << ",\"calls\":" << method.calls
+            << ",\"total_ms\":" << method.totalNs / 1e6
+            << ",\"mean_us\":" << method.totalNs / 1e3 / method.calls
+            << ",\"max_us\":" << method.maxNs / 1e3
+            << ",\"allocations\":" << method.allocations
+            << ",\"allocated_bytes\":" << method.allocatedBytes << "}";
+        first = false;
+    }
+    err << "]}" << std::endl;
+}
+
+void writeCommandFields(std::ostream& out, const BatchOptions& options, AnswerAnalyzer& analyzer) {
+    out << ",\"attempts\":" << analyzer.getNumAttempts()
+        << ",\"questions\":" << (analyzer.getNumAttempts() ? analyzer.getFirstAttemptSize() : 0);
+
+    switch (options.command) {
+        case BatchCommand::Analyze: {
+            analyzer.analyzeResults();
+            const auto& definite = analyzer.getDefiniteAnswers();
+            out << ",\"definite\":[";
+            for (size_t q = 0; q < analyzer.getFirstAttemptSize() && q < definite.size(); ++q) {
+                if (q > 0) {
+                    out << ',';
+                }
+                out << (!definite[q] ? "null" : *definite[q] ? "true" : "false");
+            }
+            out << "],\"model_count\":";
+            if (auto count = analyzer.getModelCount()) {
+                out << *count;
+            } else {
+                out << "null";
+            }
+            break;
+        }
+
+        case BatchCommand::Suggest: {
+            auto suggestion = analyzer.suggestNextAttempt(options.suggestion);
+            out << ",\"suggestion\":";
+            writeJsonStrings(out, suggestion);
+            out << ",\"predicted\":" << analyzer.predictScore(suggestion);
+            break;
+        }
+
+        case BatchCommand::Predict:
+            out << ",\"predicted\":" << analyzer.predictScore(options.sheet);
+            break;
+
+        case BatchCommand::Stats:
+            out << ",\"average\":" << analyzer.getAverageScore()
+                << ",\"variance\":" << analyzer.getScoreVariance()
+                << ",\"most_common\":";
+            writeJsonStrings(out, analyzer.getMostCommonAnswers());
+            break;
+
+        case BatchCommand::Grade:
+        case BatchCommand::Convert:
+            break;
+    }
+}
+
+}  // namespace
+
+void printBatchUsage(std::ostream& out) {
+    out << "Usage: analyzer <command> [options] <file>...\n"
+        << "\nCommands (one JSON object per file on stdout):\n"
+        << "  analyze <file>...           definite answers for the latest attempt\n"
+        << "  suggest <file>...           suggested sheet for the next attempt\n"
+        << "  predict <sheet> <file>...   predicted score of a comma-separated sheet\n"
+        << "  stats <file>...             attempt count, score statistics, common answers\n"
+        << "  convert <in> <out>...       rewrite attempt files (--binary, --text, --compressed)\n"
+        << "  grade <key> <in> <out>...   grade sheets (one per line) into attempt files\n"
+        << "  serve [file]                analysis server until Ctrl-C (--socket or --port)\n"
+        << "  loadgen <sheet>             time predict requests against a server\n"
+        << "\nOptions:\n"
+        << "  --files-from <path>   read more file names, one per line ('-' for stdin)\n"
+        << "  --threads <n>         worker threads, 0 = one per core (default 1)\n"
+        << "  --max-questions <n>   largest test accepted (default 10)\n"
+        << "  --stream              stats: fold files without keeping their attempts\n"
+        << "  --iterations <n>      suggest: search moves (default 20000)\n"
+        << "  --seed <n>            suggest: random seed (default 1)\n"
+        << "  --binary, --text, --compressed\n"
+        << "                        convert, grade: output format (default binary)\n"
+        << "  --timing              add load_ms and run_ms to each record and totals on stderr\n"
+        << "  --profile             per-method calls and times on stderr\n"
+        << "  --scorer <name>       answer confidences: heuristic (default) or em\n"
+        << "  --fuzzy <edits>       merge answers differing in spacing, case or a few edits\n"
+        << "  --socket <path>       serve, loadgen: Unix socket to listen on or connect to\n"
+        << "  --port <n>            serve, loadgen: TCP port on 127.0.0.1 instead\n"
+        << "  --batch-window <us>   serve: wait for more predicts before scoring a batch\n"
+        << "  --data-dir <path>     serve: directory for load and save requests (off by default)\n"
+        << "  --clients <n>         loadgen: concurrent connections (default 8)\n"
+        << "  --requests <n>        loadgen: requests per connection (default 1000)\n"
+        << "\nRun without arguments for the interactive menu." << std::endl;
+}
+
+int runBatch(const std::vector<std::string>& args, std::ostream& out, std::ostream& err) {
+    const Clock::time_point started = Clock::now();
+
+    if (!args.empty() && (args[0] == "--help" || args[0] == "-h" || args[0] == "help")) {
+        printBatchUsage(out);
+        return 0;
+    }
+    if (!args.empty() && (args[0] == "serve" || args[0] == "loadgen")) {
+        return runServerCommand(args, out, err);
+    }
+
+    BatchOptions options;
+    try {
+        options = parseArguments(args);
+    } catch (const BatchCliException& e) {
+        err << "Error: " << e.what() << "\n";
+        printBatchUsage(err);
+        return 2;
+    }
+
+    if (options.profile) {
+        AnswerAnalyzer::resetMetrics();
+        AnswerAnalyzer::setMetricsEnabled(true);
+    }
+
+    // One analyzer serves every file, so the thread pool and the buffers
+    // behind the summaries are set up once rather than per file
+    AnswerAnalyzer analyzer(options.maxQuestions);
+    analyzer.setThreadCount(options.threads);
+    if (options.emScorer) {
+        analyzer.setScorer(std::make_shared<EmScorer>());
+    }
+    if (options.fuzzyEdits) {
+        FuzzyMatchOptions matching;
+        matching.maxEdits = *options.fuzzyEdits;
+        analyzer.setFuzzyMatching(matching);
+    }
+    out << std::setprecision(10);
+
+    // The grader's thread pool is likewise shared by every file
+    std::unique_ptr<BulkGrader> grader;
+    if (options.command == BatchCommand::Grade) {
+        BulkGraderOptions graderOptions;
+        graderOptions.threads = options.threads;
+        try {
+            grader = std::make_unique<BulkGrader>(options.sheet, graderOptions);
+        } catch (const BulkGraderException& e) {
+            err << "Error: " << e.what() << std::endl;
+            return 2;
+        }
+    }
+
+    const bool converting = options.command == BatchCommand::Convert;
+    const bool paired = converting || grader;
+    const size_t step = paired ? 2 : 1;
+    size_t failed = 0;
+    double loadTotal = 0.0;
+    double runTotal = 0.0;
+    const Clock::time_point firstFile = Clock::now();
+
+    for (size_t i = 0; i < options.files.size(); i += step) {
+        const std::string& file = options.files[i];
+        Clock::time_point start = Clock::now();
+        Clock::time_point loaded = start;
+
+        // Build the record aside so a failure half way still prints valid JSON
+        std::ostringstream record;
+        record << std::setprecision(10);
+        record << "{\"file\":";
+        writeJsonString(record, file);
+        try {
+            if (converting) {
+                AnswerAnalyzer::convertFile(file, options.files[i + 1], options.convertFormat);
+                record << ",\"output\":";
+                writeJsonString(record, options.files[i + 1]);
+                loaded = Clock::now();
+            } else if (grader) {
+                gradeFile(options, *grader, file, options.files[i + 1], record);
+                loaded = Clock::now();
+            } else {
+                if (options.stream) {
+                    analyzer.streamFromFile(file);
+                } else {
+                    analyzer.loadFromFile(file);
+                }
+                loaded = Clock::now();
+                writeCommandFields(record, options, analyzer);
+            }
+        } catch (const std::exception& e) {
+            failed++;
+            record.str("");
+            record << "{\"file\":";
+            writeJsonString(record, file);
+            record << ",\"error\":";
+            writeJsonString(record, e.what());
+        }
+
+        Clock::time_point end = Clock::now();
+        if (options.timing) {
+            loadTotal += elapsedMs(start, loaded);
+            runTotal += elapsedMs(loaded, end);
+            record << ",\"load_ms\":" << elapsedMs(start, loaded)
+                   << ",\"run_ms\":" << elapsedMs(loaded, end);
+        }
+        record << "}\n";
+        out << record.str();
+    }
+    out.flush();
+
+    if (options.timing) {
+        const size_t files = (options.files.size() + step - 1) / step;
+        const double total = elapsedMs(started, Clock::now());
+        err << std::fixed << std::setprecision(3)
+            << "{\"files\":" << files << ",\"failed\":" << failed
+            << ",\"startup_ms\":" << elapsedMs(started, firstFile)
+            << ",\"load_ms\":" << loadTotal << ",\"run_ms\":" << runTotal
+            << ",\"overhead_ms\":" << total - loadTotal - runTotal
+            << ",\"total_ms\":" << total << "}" << std::endl;
+    }
+
+    if (options.profile) {
+        AnswerAnalyzer::setMetricsEnabled(false);
+        writeProfile(err);
+    }
+
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,35 @@
+#ifndef BATCH_CLI_H
+#define BATCH_CLI_H
+
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Custom exception class for batch command line errors
+class BatchCliException : public std::runtime_error {
+public:
+    explicit BatchCliException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+// Non-interactive entry point: runs one subcommand over any number of
+// attempt files and writes one JSON object per file to out. Problems with a
+// single file are reported in that file's record and processing continues.
+//
+//   analyze <file>...            definite answers for the latest attempt
+//   suggest <file>...            suggested sheet for the next attempt
+//   predict <sheet> <file>...    predicted score of a comma-separated sheet
+//   stats <file>...              attempt count, score statistics, common answers
+//   convert <in> <out>...        rewrite attempt files in another format
+//   grade <key> <in> <out>...    grade answer sheets into attempt files
+//   serve [file]                 run an AnalysisServer until SIGINT or SIGTERM
+//   loadgen <sheet>              measure predict latency against a server
+//
+// Returns 0 on success, 1 if any file failed and 2 for usage errors.
+int runBatch(const std::vector<std::string>& args, std::ostream& out, std::ostream& err);
+
+// Help text for runBatch
+void printBatchUsage(std::ostream& out);
+
+#endif
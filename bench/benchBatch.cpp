@@ -0,0 +1,91 @@
+// Benchmark for the batch command line
+//
+// Writes many small attempt histories and runs the stats and analyze
+// subcommands over all of them in one runBatch call, reporting the cost per
+// file and how much of it is spent outside loading and the command itself.
+
+#include "../answerAnalyzer.h"
+#include "../batchCli.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kFiles = 500;
+const size_t kQuestions = 10;
+const size_t kAttempts = 20;
+const char* const kAlphabet[] = {"a", "b", "c", "d"};
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "benchBatch";
+    std::filesystem::create_directories(directory);
+    
+    std::vector<std::string> textFiles;
+    std::vector<std::string> binaryFiles;
+    for (size_t f = 0; f < kFiles; ++f) {
+        AnswerAnalyzer analyzer(kQuestions);
+        std::vector<std::string> key(kQuestions);
+        for (auto& answer : key) {
+            answer = kAlphabet[rng() % 4];
+        }
+        for (size_t i = 0; i < kAttempts; ++i) {
+            std::vector<std::string> sheet(kQuestions);
+            size_t correct = 0;
+            for (size_t q = 0; q < kQuestions; ++q) {
+                sheet[q] = kAlphabet[rng() % 4];
+                correct += sheet[q] == key[q];
+            }
+            analyzer.addAttempt(sheet, 100.0 * correct / kQuestions);
+        }
+        std::string base = (directory / ("history" + std::to_string(f))).string();
+        analyzer.saveToFile(base + ".txt", FileFormat::Text);
+        analyzer.saveToFile(base + ".bin", FileFormat::Binary);
+        textFiles.push_back(base + ".txt");
+        binaryFiles.push_back(base + ".bin");
+    }
+    
+    std::cout << kFiles << " files of " << kAttempts << " attempts x " << kQuestions
+              << " questions, one runBatch call each" << std::endl;
+    std::cout << std::setw(10) << "command" << std::setw(8) << "format"
+              << std::setw(14) << "ms/file" << "  timing totals" << std::endl;
+    
+    int status = 0;
+    for (const char* command : {"stats", "analyze"}) {
+        for (bool binary : {false, true}) {
+            std::vector<std::string> args = {command, "--timing"};
+            const auto& files = binary ? binaryFiles : textFiles;
+            args.insert(args.end(), files.begin(), files.end());
+            
+            std::ostringstream out;
+            std::ostringstream err;
+            auto start = std::chrono::steady_clock::now();
+            status |= runBatch(args, out, err);
+            double ms = elapsedMs(start);
+            
+            std::string totals = err.str();
+            totals.erase(totals.find_last_not_of('\n') + 1);
+            std::cout << std::setw(10) << command << std::setw(8) << (binary ? "binary" : "text")
+                      << std::setw(14) << std::fixed << std::setprecision(4) << ms / kFiles
+                      << "  " << totals << std::endl;
+        }
+    }
+    
+    std::filesystem::remove_all(directory);
+    return status;
+}
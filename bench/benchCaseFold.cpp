@@ -0,0 +1,131 @@
+// Benchmark for case-insensitive answer comparison
+//
+// Grades a large sheet of expected/actual pairs three ways: lowercasing
+// copies of both strings per comparison as the tracker used to, comparing
+// with equalsIgnoreCase, and comparing forms folded once up front. Fails if
+// the fast paths ever disagree with the copying reference, which is also
+// checked byte by byte over every pair of single-byte strings.
+
+#include "../caseFold.h"
+#include "benchTiming.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kPairs = 1000000;
+
+std::string lowered(const std::string& text) {
+    std::string result = text;
+    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+    return result;
+}
+
+// Mixed-case ASCII and UTF-8 answers of 1 to 64 bytes; half the actual
+// answers are the expected one with its case scrambled
+void makeSheet(std::vector<std::string>& expected, std::vector<std::string>& actual) {
+    static const char* const kWords[] = {"Paris", "Zürich", "ÉTÉ", "x", "Answer", "[@`{]"};
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<size_t> pickWord(0, 5);
+    std::uniform_int_distribution<size_t> pickLength(1, 64);
+    for (size_t i = 0; i < kPairs; ++i) {
+        std::string answer;
+        const size_t length = pickLength(rng);
+        while (answer.size() < length) {
+            answer += kWords[pickWord(rng)];
+        }
+        std::string other = answer;
+        if (rng() % 2 == 0) {
+            for (char& c : other) {
+                if (std::isalpha(static_cast<unsigned char>(c)) && rng() % 2 == 0) {
+                    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                }
+            }
+        } else {
+            other[rng() % other.size()] ^= 0x01;
+        }
+        expected.push_back(std::move(answer));
+        actual.push_back(std::move(other));
+    }
+}
+
+}  // namespace
+
+int main() {
+    bool mismatched = false;
+    for (int a = 0; a < 256; ++a) {
+        for (int b = 0; b < 256; ++b) {
+            const std::string left(1, static_cast<char>(a));
+            const std::string right(1, static_cast<char>(b));
+            std::string folded = left;
+            foldCase(folded);
+            if (equalsIgnoreCase(left, right) != (lowered(left) == lowered(right)) ||
+                folded != lowered(left)) {
+                mismatched = true;
+            }
+        }
+    }
+
+    std::vector<std::string> expected;
+    std::vector<std::string> actual;
+    makeSheet(expected, actual);
+
+    std::cout << kPairs << " pairs" << std::endl;
+    std::cout << std::setw(24) << "method" << std::setw(12) << "ms" << std::setw(12)
+              << "correct" << std::endl;
+
+    size_t reference = 0;
+    auto run = [&](const char* method, auto&& grade) {
+        auto start = std::chrono::steady_clock::now();
+        size_t correct = grade();
+        double ms = elapsedMs(start);
+        std::cout << std::setw(24) << method << std::fixed << std::setprecision(1)
+                  << std::setw(12) << ms << std::setw(12) << correct << std::endl;
+        if (reference == 0) {
+            reference = correct;
+        } else if (correct != reference) {
+            mismatched = true;
+        }
+    };
+
+    run("lowercased copies", [&]() {
+        size_t correct = 0;
+        for (size_t i = 0; i < kPairs; ++i) {
+            correct += lowered(expected[i]) == lowered(actual[i]);
+        }
+        return correct;
+    });
+    run("equalsIgnoreCase", [&]() {
+        size_t correct = 0;
+        for (size_t i = 0; i < kPairs; ++i) {
+            correct += equalsIgnoreCase(expected[i], actual[i]);
+        }
+        return correct;
+    });
+
+    std::vector<std::string> foldedExpected = expected;
+    std::vector<std::string> foldedActual = actual;
+    for (size_t i = 0; i < kPairs; ++i) {
+        foldCase(foldedExpected[i]);
+        foldCase(foldedActual[i]);
+    }
+    run("prefolded", [&]() {
+        size_t correct = 0;
+        for (size_t i = 0; i < kPairs; ++i) {
+            correct += foldedExpected[i] == foldedActual[i];
+        }
+        return correct;
+    });
+
+    if (mismatched) {
+        std::cerr << "case folding disagrees with the lowercasing reference" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+// Benchmark for the compressed attempt format
+//
+// Saves two synthetic histories in the text, binary and compressed formats:
+// a drifting one where each attempt changes a few answers of the one
+// before, as real retakes do, and one of independent random sheets. Reports
+// the file sizes, load times and the cost of reading single attempts at
+// random indices. Also round-trips random buffers through the LZ block
+// codec. Fails if anything read back differs from what was written.
+
+#include "../answerAnalyzer.h"
+#include "../compressedHistory.h"
+#include "../lzBlock.h"
+#include "benchTiming.h"
+#include "syntheticAttempts.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kQuestions = 50;
+const size_t kAttempts = 100000;
+const size_t kRandomReads = 100000;
+
+typedef std::chrono::steady_clock Clock;
+
+bool checkLzBlocks() {
+    std::mt19937 rng(9);
+    std::string data;
+    std::string packed;
+    std::string unpacked;
+    for (size_t trial = 0; trial < 2000; ++trial) {
+        // From incompressible noise to long runs of a few letters
+        const size_t size = rng() % 5000;
+        const unsigned letters = 1 + rng() % 256;
+        data.clear();
+        while (data.size() < size) {
+            const char c = static_cast<char>(rng() % letters);
+            data.append(std::min<size_t>(1 + rng() % 40, size - data.size()), c);
+        }
+        packed.clear();
+        lzCompressBlock(data.data(), data.size(), packed);
+        unpacked.assign(data.size(), '\0');
+        if (!lzDecompressBlock(packed.data(), packed.size(), &unpacked[0], unpacked.size()) ||
+            unpacked != data) {
+            std::cerr << "LZ round trip failed for " << size << " bytes" << std::endl;
+            return false;
+        }
+        // A truncated block must be rejected, never overrun
+        if (!packed.empty() &&
+            lzDecompressBlock(packed.data(), packed.size() - 1, &unpacked[0], unpacked.size())) {
+            std::cerr << "truncated LZ block accepted" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Each attempt keeps most answers of the previous one
+SyntheticHistory driftingHistory() {
+    SyntheticSpec spec;
+    spec.questions = kQuestions;
+    spec.attempts = 1;
+    spec.alphabet = 5;
+    SyntheticHistory history = generateAttempts(spec);
+
+    std::mt19937 rng(7);
+    for (size_t i = 1; i < kAttempts; ++i) {
+        std::vector<std::string> sheet = history.attempts.back();
+        for (size_t change = rng() % 4; change > 0; --change) {
+            sheet[rng() % kQuestions] = syntheticAnswer(rng() % spec.alphabet);
+        }
+        size_t correct = 0;
+        for (size_t q = 0; q < kQuestions; ++q) {
+            correct += sheet[q] == history.key[q];
+        }
+        history.attempts.push_back(std::move(sheet));
+        history.percentages.push_back(100.0 * correct / kQuestions);
+    }
+    return history;
+}
+
+bool sameHistory(const AnswerAnalyzer& analyzer, const SyntheticHistory& history) {
+    if (analyzer.getNumAttempts() != history.attempts.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < history.attempts.size(); ++i) {
+        TestAttempt attempt = analyzer.getAttempt(i);
+        if (attempt.answers != history.attempts[i] ||
+            attempt.percentage != history.percentages[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool run(const char* name, const SyntheticHistory& history, const std::string& path) {
+    AnswerAnalyzer analyzer(kQuestions);
+    std::vector<TestAttempt> batch;
+    for (size_t i = 0; i < history.attempts.size(); ++i) {
+        batch.emplace_back(history.attempts[i], history.percentages[i]);
+    }
+    analyzer.addAttempts(std::move(batch));
+
+    std::cout << name << ", " << history.attempts.size() << " attempts of " << kQuestions
+              << " questions" << std::endl;
+    std::cout << std::setw(14) << "format" << std::setw(12) << "bytes" << std::setw(12)
+              << "save ms" << std::setw(12) << "load ms" << std::endl;
+
+    struct Format {
+        const char* name;
+        FileFormat format;
+    };
+    bool ok = true;
+    for (const Format& format : {Format{"text", FileFormat::Text},
+                                 Format{"binary", FileFormat::Binary},
+                                 Format{"compressed", FileFormat::Compressed}}) {
+        Clock::time_point start = Clock::now();
+        analyzer.saveToFile(path, format.format);
+        const double saveMs = elapsedMs(start);
+
+        AnswerAnalyzer loaded(kQuestions);
+        start = Clock::now();
+        loaded.loadFromFile(path);
+        const double loadMs = elapsedMs(start);
+
+        std::cout << std::setw(14) << format.name << std::setw(12)
+                  << std::filesystem::file_size(path) << std::fixed << std::setprecision(1)
+                  << std::setw(12) << saveMs << std::setw(12) << loadMs << std::endl;
+        if (!sameHistory(loaded, history)) {
+            std::cerr << format.name << ": loaded history differs" << std::endl;
+            ok = false;
+        }
+    }
+
+    // Without LZ, to show what the delta encoding alone achieves
+    {
+        std::ofstream out(path, std::ios::binary);
+        CompressionOptions options;
+        options.lz = false;
+        CompressedHistory::write(analyzer.getAttemptStore(), out, options);
+    }
+    std::cout << std::setw(14) << "deltas only" << std::setw(12) << std::filesystem::file_size(path)
+              << std::endl;
+
+    // Random access decodes one block per read at worst
+    analyzer.saveToFile(path, FileFormat::Compressed);
+    CompressedHistory compressed(path);
+    std::mt19937 rng(11);
+    Clock::time_point start = Clock::now();
+    size_t mismatches = 0;
+    for (size_t read = 0; read < kRandomReads; ++read) {
+        const size_t i = rng() % history.attempts.size();
+        mismatches += compressed.answers(i) != history.attempts[i];
+    }
+    std::cout << "random reads: " << std::setprecision(2)
+              << 1e3 * elapsedMs(start) / kRandomReads << " us each over "
+              << compressed.numBlocks() << " blocks" << std::endl << std::endl;
+    if (mismatches > 0) {
+        std::cerr << mismatches << " random reads differ" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+}  // namespace
+
+int main() {
+    bool ok = checkLzBlocks();
+
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "benchCompression.dat").string();
+    ok = run("drifting", driftingHistory(), path) && ok;
+
+    SyntheticSpec spec;
+    spec.questions = kQuestions;
+    spec.attempts = kAttempts;
+    spec.alphabet = 5;
+    ok = run("independent", generateAttempts(spec), path) && ok;
+
+    std::filesystem::remove(path);
+    return ok ? 0 : 1;
+}
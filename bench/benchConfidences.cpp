@@ -0,0 +1,74 @@
+// Benchmark for recomputing the answer confidences
+//
+// Interleaves addAttempt with getAnswerConfidences, as a live session does,
+// so every call recomputes the confidences from the grown history. Reports
+// the time and heap allocations per recomputation, and fails if the
+// recomputation allocates in the steady state: its buffers should only grow
+// when the history outgrows them.
+
+#include "../answerAnalyzer.h"
+#include "syntheticAttempts.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kWarmAttempts = 2000;
+const size_t kRounds = 2000;
+const SyntheticSpec kShapes[] = {
+    // questions, attempts, alphabet, noise
+    {10, kWarmAttempts + kRounds, 4, 0.3, 1},
+    {50, kWarmAttempts + kRounds, 8, 0.5, 2},
+};
+
+// Growth of a handful of scratch buffers is fine; an allocation per call is not
+const double kMaxAllocationsPerCall = 0.01;
+
+}  // namespace
+
+int main() {
+    std::cout << std::setw(10) << "questions" << std::setw(10) << "answers"
+              << std::setw(16) << "us per call" << std::setw(18) << "allocs per call" << std::endl;
+
+    bool allocating = false;
+    for (const SyntheticSpec& spec : kShapes) {
+        SyntheticHistory history = generateAttempts(spec);
+        AnswerAnalyzer analyzer(spec.questions);
+        std::vector<std::pair<std::string, double>> confidences;
+        for (size_t i = 0; i < kWarmAttempts; ++i) {
+            analyzer.addAttempt(history.attempts[i], history.percentages[i]);
+        }
+        analyzer.getAnswerConfidences(confidences);
+
+        AnswerAnalyzer::resetMetrics();
+        AnswerAnalyzer::setMetricsEnabled(true);
+        for (size_t i = kWarmAttempts; i < kWarmAttempts + kRounds; ++i) {
+            analyzer.addAttempt(history.attempts[i], history.percentages[i]);
+            analyzer.getAnswerConfidences(confidences);
+        }
+        AnswerAnalyzer::setMetricsEnabled(false);
+
+        for (const MethodMetrics& method : AnswerAnalyzer::getMetrics()) {
+            if (method.method != "AnswerAnalyzer::getAnswerConfidences") {
+                continue;
+            }
+            double perCall = static_cast<double>(method.allocations) / method.calls;
+            std::cout << std::setw(10) << spec.questions << std::setw(10) << spec.alphabet
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(16) << method.totalNs / 1e3 / method.calls
+                      << std::setprecision(4) << std::setw(18) << perCall << std::endl;
+            allocating = allocating || perCall > kMaxAllocationsPerCall;
+        }
+    }
+
+#if ANALYZER_ALLOCATION_METRICS
+    if (allocating) {
+        std::cout << "getAnswerConfidences allocates in the steady state" << std::endl;
+        return 1;
+    }
+#endif
+    return 0;
+}
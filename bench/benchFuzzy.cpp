@@ -0,0 +1,150 @@
+// Benchmark for fuzzy answer matching
+//
+// Checks boundedLevenshtein against the plain dynamic program on random
+// strings on both sides of the 64-byte word limit, then adds free-text
+// attempts with typos, stray spaces and case changes to analyzers with and
+// without fuzzy matching and reports the cost per attempt and the distinct
+// answers left per question. Fails on any distance mismatch.
+
+#include "../answerAnalyzer.h"
+#include "../fuzzyMatch.h"
+#include "benchTiming.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kAttempts = 100000;
+const size_t kQuestions = 5;
+const size_t kWordsPerQuestion = 500;
+
+size_t plainLevenshtein(const std::string& a, const std::string& b) {
+    std::vector<size_t> previous(b.size() + 1);
+    std::vector<size_t> current(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); ++j) {
+        previous[j] = j;
+    }
+    for (size_t i = 1; i <= a.size(); ++i) {
+        current[0] = i;
+        for (size_t j = 1; j <= b.size(); ++j) {
+            const size_t substitute = previous[j - 1] + (a[i - 1] != b[j - 1] ? 1 : 0);
+            current[j] = std::min({substitute, previous[j] + 1, current[j - 1] + 1});
+        }
+        std::swap(previous, current);
+    }
+    return previous[b.size()];
+}
+
+std::string randomWord(std::mt19937& rng, size_t minLength, size_t maxLength, char letters) {
+    std::uniform_int_distribution<size_t> pickLength(minLength, maxLength);
+    std::uniform_int_distribution<int> pickLetter(0, letters - 1);
+    std::string word(pickLength(rng), 'a');
+    for (char& c : word) {
+        c = static_cast<char>('a' + pickLetter(rng));
+    }
+    return word;
+}
+
+// One edit, a capital or stray spaces, or none
+std::string misspell(std::string word, std::mt19937& rng) {
+    switch (rng() % 6) {
+        case 0:
+            word[rng() % word.size()] = static_cast<char>('a' + rng() % 26);
+            break;
+        case 1:
+            word.erase(rng() % word.size(), 1);
+            break;
+        case 2:
+            word[0] = static_cast<char>(word[0] - 'a' + 'A');
+            break;
+        case 3:
+            word = " " + word + "  ";
+            break;
+        default:
+            break;
+    }
+    return word;
+}
+
+bool checkDistances() {
+    std::mt19937 rng(3);
+    for (size_t trial = 0; trial < 100000; ++trial) {
+        const size_t longest = trial % 2 == 0 ? 20 : 150;
+        const std::string a = randomWord(rng, 0, longest, 3);
+        std::string b = a;
+        for (size_t edit = rng() % 6; edit > 0; --edit) {
+            if (b.empty() || rng() % 3 == 0) {
+                b.insert(b.begin() + rng() % (b.size() + 1), static_cast<char>('a' + rng() % 3));
+            } else if (rng() % 2 == 0) {
+                b.erase(b.begin() + rng() % b.size());
+            } else {
+                b[rng() % b.size()] = static_cast<char>('a' + rng() % 3);
+            }
+        }
+        const size_t bound = rng() % 6;
+        const size_t exact = plainLevenshtein(a, b);
+        if (boundedLevenshtein(a, b, bound) != std::min(exact, bound + 1)) {
+            std::cerr << "distance mismatch: \"" << a << "\" \"" << b << "\" bound " << bound
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main() {
+    if (!checkDistances()) {
+        return 1;
+    }
+
+    std::mt19937 rng(5);
+    std::vector<std::vector<std::string>> words(kQuestions);
+    for (std::vector<std::string>& question : words) {
+        for (size_t w = 0; w < kWordsPerQuestion; ++w) {
+            question.push_back(randomWord(rng, 5, 14, 26));
+        }
+    }
+    std::vector<std::vector<std::string>> sheets(kAttempts, std::vector<std::string>(kQuestions));
+    std::vector<double> percentages(kAttempts);
+    for (size_t i = 0; i < kAttempts; ++i) {
+        for (size_t q = 0; q < kQuestions; ++q) {
+            sheets[i][q] = misspell(words[q][rng() % kWordsPerQuestion], rng);
+        }
+        percentages[i] = 20.0 * (rng() % 6);
+    }
+
+    std::cout << kAttempts << " attempts, " << kQuestions << " questions, "
+              << kWordsPerQuestion << " words per question" << std::endl;
+    std::cout << std::setw(12) << "matching" << std::setw(16) << "us per attempt"
+              << std::setw(20) << "answers/question" << std::endl;
+
+    for (bool fuzzy : {false, true}) {
+        AnswerAnalyzer analyzer(kQuestions);
+        if (fuzzy) {
+            analyzer.setFuzzyMatching(FuzzyMatchOptions());
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < kAttempts; ++i) {
+            analyzer.addAttempt(sheets[i], percentages[i]);
+        }
+        double us = 1e3 * elapsedMs(start);
+
+        const AttemptStore& store = analyzer.getAttemptStore();
+        size_t answers = 0;
+        for (size_t q = 0; q < kQuestions; ++q) {
+            answers += store.numAnswers(q);
+        }
+        std::cout << std::setw(12) << (fuzzy ? "fuzzy" : "exact") << std::fixed
+                  << std::setprecision(3) << std::setw(16) << us / kAttempts
+                  << std::setprecision(0) << std::setw(20)
+                  << static_cast<double>(answers) / kQuestions << std::endl;
+    }
+    return 0;
+}
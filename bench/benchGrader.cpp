@@ -0,0 +1,109 @@
+// Benchmark for bulk grading
+//
+// Grades 50,000 synthetic sheets of 50 answers against one key, in memory
+// with gradeAll and from text with gradeStream, at one thread and at one
+// per core, and feeds the streamed result into an analyzer. Fails if any
+// run's percentages differ from the synthetic generator's exact scores.
+
+#include "../bulkGrader.h"
+#include "syntheticAttempts.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const size_t kSheets = 50000;
+const size_t kQuestions = 50;
+
+}  // namespace
+
+int main() {
+    SyntheticSpec spec;
+    spec.questions = kQuestions;
+    spec.attempts = kSheets;
+    spec.alphabet = 5;
+    spec.noise = 0.5;
+    const SyntheticHistory history = generateAttempts(spec);
+
+    std::string text;
+    for (const std::vector<std::string>& sheet : history.attempts) {
+        for (size_t q = 0; q < sheet.size(); ++q) {
+            text += (q > 0 ? "," : "") + sheet[q];
+        }
+        text += '\n';
+    }
+
+    std::cout << kSheets << " sheets of " << kQuestions << " answers" << std::endl;
+    std::cout << std::setw(12) << "mode" << std::setw(10) << "threads" << std::setw(12) << "ms"
+              << std::setw(16) << "sheets/s" << std::endl;
+
+    bool mismatched = false;
+    auto check = [&](const std::vector<TestAttempt>& graded) {
+        if (graded.size() != kSheets) {
+            mismatched = true;
+            return;
+        }
+        for (size_t i = 0; i < kSheets; ++i) {
+            if (graded[i].percentage != history.percentages[i]) {
+                mismatched = true;
+            }
+        }
+    };
+    auto report = [](const char* mode, const BulkGrader& grader) {
+        const GradingStats& stats = grader.getStats();
+        std::cout << std::setw(12) << mode << std::setw(10) << grader.getThreadCount()
+                  << std::fixed << std::setprecision(1) << std::setw(12) << stats.seconds * 1000.0
+                  << std::setprecision(0) << std::setw(16) << stats.sheetsPerSecond() << std::endl;
+    };
+
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t threads : {static_cast<size_t>(1), cores}) {
+        BulkGraderOptions options;
+        options.threads = threads;
+
+        {
+            BulkGrader grader(history.key, options);
+            std::vector<TestAttempt> sheets;
+            for (const std::vector<std::string>& sheet : history.attempts) {
+                sheets.emplace_back(sheet, 0.0);
+            }
+            grader.gradeAll(sheets);
+            report("gradeAll", grader);
+            check(sheets);
+        }
+
+        {
+            BulkGrader grader(history.key, options);
+            std::istringstream in(text);
+            std::vector<TestAttempt> graded;
+            grader.gradeStream(in, [&](std::vector<TestAttempt>& chunk) {
+                for (TestAttempt& sheet : chunk) {
+                    graded.push_back(std::move(sheet));
+                }
+            });
+            report("gradeStream", grader);
+            check(graded);
+
+            AnswerAnalyzer analyzer(kQuestions);
+            analyzer.addAttempts(std::move(graded));
+            if (analyzer.getNumAttempts() != kSheets) {
+                mismatched = true;
+            }
+        }
+
+        if (threads == cores) {
+            break;
+        }
+    }
+
+    if (mismatched) {
+        std::cerr << "graded percentages differ from the exact scores" << std::endl;
+        return 1;
+    }
+    return 0;
+}
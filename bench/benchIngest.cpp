@@ -0,0 +1,80 @@
+// Benchmark for attempt ingestion
+//
+// Adds a million synthetic records to a fresh analyzer three ways: one
+// addAttempt call per record with copied answers, one per record with
+// moved answers, and a single addAttempts call for the whole batch.
+
+#include "../answerAnalyzer.h"
+#include "benchTiming.h"
+#include "syntheticAttempts.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const size_t kRecords = 1000000;
+const size_t kQuestions = 10;
+
+std::vector<TestAttempt> makeBatch(const SyntheticHistory& history) {
+    std::vector<TestAttempt> batch;
+    batch.reserve(history.attempts.size());
+    for (size_t i = 0; i < history.attempts.size(); ++i) {
+        batch.emplace_back(history.attempts[i], history.percentages[i]);
+    }
+    return batch;
+}
+
+}  // namespace
+
+int main() {
+    SyntheticSpec spec;
+    spec.questions = kQuestions;
+    spec.attempts = kRecords;
+    spec.alphabet = 5;
+    spec.noise = 0.5;
+    const SyntheticHistory history = generateAttempts(spec);
+
+    std::cout << kRecords << " records of " << kQuestions << " answers" << std::endl;
+    std::cout << std::setw(24) << "method" << std::setw(12) << "ms" << std::setw(16)
+              << "records/s" << std::endl;
+
+    auto report = [](const char* method, std::chrono::steady_clock::time_point start,
+                     const AnswerAnalyzer& analyzer) {
+        double ms = elapsedMs(start);
+        std::cout << std::setw(24) << method << std::fixed << std::setprecision(1)
+                  << std::setw(12) << ms << std::setprecision(0) << std::setw(16)
+                  << analyzer.getNumAttempts() / ms * 1000.0 << std::endl;
+    };
+
+    {
+        AnswerAnalyzer analyzer(kQuestions);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < kRecords; ++i) {
+            analyzer.addAttempt(history.attempts[i], history.percentages[i]);
+        }
+        report("addAttempt (copy)", start, analyzer);
+    }
+
+    {
+        std::vector<TestAttempt> batch = makeBatch(history);
+        AnswerAnalyzer analyzer(kQuestions);
+        auto start = std::chrono::steady_clock::now();
+        for (TestAttempt& attempt : batch) {
+            analyzer.addAttempt(std::move(attempt.answers), attempt.percentage);
+        }
+        report("addAttempt (move)", start, analyzer);
+    }
+
+    {
+        std::vector<TestAttempt> batch = makeBatch(history);
+        AnswerAnalyzer analyzer(kQuestions);
+        auto start = std::chrono::steady_clock::now();
+        analyzer.addAttempts(std::move(batch));
+        report("addAttempts (batch)", start, analyzer);
+    }
+    return 0;
+}
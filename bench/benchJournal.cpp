@@ -0,0 +1,172 @@
+// Benchmark for the attempt journal
+//
+// Compares saving the whole history after every attempt with journaling
+// each attempt, syncing every record and every 64 records, then times
+// recovery of the journal into a fresh analyzer. Also replays the crashes
+// the journal is meant to survive: a record torn in half, and a compaction
+// interrupted between writing the snapshot and starting the new journal.
+// Fails if any recovered history differs from what was added.
+
+#include "../answerAnalyzer.h"
+#include "../attemptJournal.h"
+#include "benchTiming.h"
+#include "syntheticAttempts.h"
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kQuestions = 20;
+const size_t kAttempts = 20000;
+const size_t kRewriteAttempts = 2000;  // the full rewrite is quadratic
+const size_t kSyncedAttempts = 2000;   // one fsync each
+
+typedef std::chrono::steady_clock Clock;
+
+void report(const char* name, size_t attempts, double ms) {
+    std::cout << std::setw(24) << name << std::fixed << std::setprecision(1) << std::setw(14)
+              << 1e3 * ms / attempts << std::setw(16) << std::setprecision(0)
+              << 1e3 * attempts / ms << std::endl;
+}
+
+// Whether analyzer holds exactly the first count synthetic attempts
+bool holds(const AnswerAnalyzer& analyzer, const SyntheticHistory& history, size_t count,
+           const char* scenario) {
+    bool same = analyzer.getNumAttempts() == count;
+    for (size_t i = 0; same && i < count; ++i) {
+        TestAttempt attempt = analyzer.getAttempt(i);
+        same = attempt.answers == history.attempts[i] &&
+               attempt.percentage == history.percentages[i];
+    }
+    if (!same) {
+        std::cerr << scenario << ": recovered " << analyzer.getNumAttempts()
+                  << " attempts, expected the first " << count << std::endl;
+    }
+    return same;
+}
+
+void removeFiles(const std::string& path) {
+    for (const char* suffix : {"", ".journal", ".journal.tmp", ".tmp"}) {
+        std::filesystem::remove(path + suffix);
+    }
+}
+
+}  // namespace
+
+int main() {
+    SyntheticSpec spec;
+    spec.questions = kQuestions;
+    spec.attempts = kAttempts;
+    spec.alphabet = 6;
+    SyntheticHistory history = generateAttempts(spec);
+
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "benchJournal.bin").string();
+    removeFiles(path);
+
+    std::cout << kQuestions << " questions" << std::endl;
+    std::cout << std::setw(24) << "save per attempt" << std::setw(14) << "us/attempt"
+              << std::setw(16) << "attempts/s" << std::endl;
+
+    {
+        AnswerAnalyzer analyzer(kQuestions);
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < kRewriteAttempts; ++i) {
+            analyzer.addAttempt(history.attempts[i], history.percentages[i]);
+            analyzer.saveToFile(path, FileFormat::Binary);
+        }
+        report("rewrite whole file", kRewriteAttempts, elapsedMs(start));
+        removeFiles(path);
+    }
+
+    JournalOptions options;
+    options.compactAfter = 0;
+    {
+        options.syncEvery = 1;
+        AnswerAnalyzer analyzer(kQuestions);
+        analyzer.openJournal(path, options);
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < kSyncedAttempts; ++i) {
+            analyzer.addAttempt(history.attempts[i], history.percentages[i]);
+        }
+        report("journal, sync every 1", kSyncedAttempts, elapsedMs(start));
+        analyzer.closeJournal();
+        removeFiles(path);
+    }
+    {
+        options.syncEvery = 64;
+        AnswerAnalyzer analyzer(kQuestions);
+        analyzer.openJournal(path, options);
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < kAttempts; ++i) {
+            analyzer.addAttempt(history.attempts[i], history.percentages[i]);
+        }
+        analyzer.syncJournal();
+        report("journal, sync every 64", kAttempts, elapsedMs(start));
+    }
+
+    bool ok = true;
+    {
+        AnswerAnalyzer analyzer(kQuestions);
+        Clock::time_point start = Clock::now();
+        analyzer.openJournal(path, options);
+        std::cout << "recovered " << analyzer.getNumAttempts() << " attempts in "
+                  << std::setprecision(1) << elapsedMs(start) << " ms" << std::endl;
+        ok = holds(analyzer, history, kAttempts, "clean recovery") && ok;
+    }
+
+    // Half of the last record reached the disk
+    const std::string journalPath = path + ".journal";
+    std::filesystem::resize_file(journalPath, std::filesystem::file_size(journalPath) - 20);
+    {
+        AnswerAnalyzer analyzer(kQuestions);
+        analyzer.openJournal(path, options);
+        ok = holds(analyzer, history, kAttempts - 1, "torn record") && ok;
+        // Appends continue from the last good record
+        analyzer.addAttempt(history.attempts[kAttempts - 1], history.percentages[kAttempts - 1]);
+    }
+    {
+        AnswerAnalyzer analyzer(kQuestions);
+        analyzer.openJournal(path, options);
+        ok = holds(analyzer, history, kAttempts, "append after torn record") && ok;
+        // A compaction that wrote its snapshot but crashed before resetting
+        // the journal
+        analyzer.saveToFile(path, FileFormat::Binary);
+    }
+    {
+        AnswerAnalyzer analyzer(kQuestions);
+        analyzer.openJournal(path, options);
+        ok = holds(analyzer, history, kAttempts, "interrupted compaction") && ok;
+    }
+    removeFiles(path);
+
+    // Compaction folds the journal into the snapshot as it grows
+    options.compactAfter = kAttempts / 8;
+    {
+        AnswerAnalyzer analyzer(kQuestions);
+        analyzer.openJournal(path, options);
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < kAttempts; ++i) {
+            analyzer.addAttempt(history.attempts[i], history.percentages[i]);
+        }
+        report("compact every 2500", kAttempts, elapsedMs(start));
+    }
+    {
+        AnswerAnalyzer analyzer(kQuestions);
+        analyzer.openJournal(path, options);
+        ok = holds(analyzer, history, kAttempts, "compacted") && ok;
+        analyzer.clear();
+    }
+    {
+        AnswerAnalyzer analyzer(kQuestions);
+        analyzer.openJournal(path, options);
+        ok = holds(analyzer, history, 0, "cleared") && ok;
+    }
+    removeFiles(path);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+// Benchmark for AnswerAnalyzer file loading
+//
+// Saves the same synthetic history in the text and the binary format, then
+// times loading each one back, including the rebuild of the per-answer
+// summaries, streaming the text file into a summary-only analyzer, and the
+// text -> binary conversion. Also checks that a loaded binary file can be
+// saved back over itself.
+
+#include "../answerAnalyzer.h"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kQuestions = 20;
+const size_t kAttempts = 200000;
+const char* const kAlphabet[] = {"alpha", "beta", "gamma", "delta", "epsilon"};
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+double fileMb(const std::string& path) {
+    return std::filesystem::file_size(path) / 1048576.0;
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, 4);
+    
+    AnswerAnalyzer analyzer(kQuestions);
+    std::vector<std::string> sheet(kQuestions);
+    for (size_t i = 0; i < kAttempts; ++i) {
+        for (auto& answer : sheet) {
+            answer = kAlphabet[pick(rng)];
+        }
+        analyzer.addAttempt(sheet, 100.0 * pick(rng) / 4);
+    }
+    
+    const std::string base = (std::filesystem::temp_directory_path() / "benchLoad").string();
+    const std::string textPath = base + ".txt";
+    const std::string binaryPath = base + ".bin";
+    const std::string convertedPath = base + ".converted.bin";
+    analyzer.saveToFile(textPath, FileFormat::Text);
+    analyzer.saveToFile(binaryPath, FileFormat::Binary);
+    
+    auto start = std::chrono::steady_clock::now();
+    AnswerAnalyzer fromText(kQuestions);
+    fromText.loadFromFile(textPath);
+    double textMs = elapsedMs(start);
+    
+    start = std::chrono::steady_clock::now();
+    AnswerAnalyzer fromBinary(kQuestions);
+    fromBinary.loadFromFile(binaryPath);
+    double binaryMs = elapsedMs(start);
+    
+    start = std::chrono::steady_clock::now();
+    AnswerAnalyzer streamed(kQuestions);
+    streamed.streamFromFile(textPath);
+    double streamMs = elapsedMs(start);
+    
+    start = std::chrono::steady_clock::now();
+    AnswerAnalyzer::convertFile(textPath, convertedPath, FileFormat::Binary);
+    double convertMs = elapsedMs(start);
+    
+    bool same = fromText.getAverageScore() == fromBinary.getAverageScore() &&
+                fromText.getAnswerConfidences() == fromBinary.getAnswerConfidences() &&
+                streamed.getScoreVariance() == fromText.getScoreVariance() &&
+                streamed.getMostCommonAnswers() == fromText.getMostCommonAnswers();
+    
+    // A loaded binary history is mapped from its file; saving or converting
+    // it over that same file must not truncate what is being read
+    fromBinary.saveToFile(binaryPath, FileFormat::Binary);
+    AnswerAnalyzer::convertFile(binaryPath, binaryPath, FileFormat::Binary);
+    AnswerAnalyzer resaved(kQuestions);
+    resaved.loadFromFile(binaryPath);
+    same = same && resaved.getNumAttempts() == kAttempts &&
+           resaved.getAnswerConfidences() == fromText.getAnswerConfidences();
+    
+    std::cout << std::fixed << std::setprecision(1)
+              << "attempts:            " << kAttempts << " x " << kQuestions << " questions\n"
+              << "text file (MB):      " << fileMb(textPath) << "\n"
+              << "binary file (MB):    " << fileMb(binaryPath) << "\n"
+              << "text load (ms):      " << textMs << "\n"
+              << "binary load (ms):    " << binaryMs << " (x" << textMs / binaryMs << ")\n"
+              << "text stream (ms):    " << streamMs << "\n"
+              << "loaded store (MB):   " << fromText.getAttemptStore().memoryUsage() / 1048576.0 << "\n"
+              << "streamed store (KB): " << streamed.getAttemptStore().memoryUsage() / 1024.0 << "\n"
+              << "text -> binary (ms): " << convertMs << "\n"
+              << "same analysis:       " << (same ? "yes" : "NO") << std::endl;
+    
+    std::remove(textPath.c_str());
+    std::remove(binaryPath.c_str());
+    std::remove(convertedPath.c_str());
+    return same ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+// Benchmark for parallel per-question analysis
+//
+// Computes confidences, most common answers and a batch of predictions on
+// the same history with 1, 2, 4, ... threads up to the core count, checks
+// that every run matches the serial output exactly and reports the speedup.
+
+#include "../answerAnalyzer.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const size_t kQuestions = 200;
+const size_t kAttempts = 20000;
+const size_t kCandidates = 200;
+const char* const kAlphabet[] = {"a", "b", "c", "d"};
+
+std::vector<std::string> randomSheet(std::mt19937& rng) {
+    std::uniform_int_distribution<int> pick(0, 3);
+    std::vector<std::string> sheet;
+    for (size_t q = 0; q < kQuestions; ++q) {
+        sheet.push_back(kAlphabet[pick(rng)]);
+    }
+    return sheet;
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    AnswerAnalyzer analyzer(kQuestions);
+    std::uniform_real_distribution<double> score(0.0, 100.0);
+    for (size_t i = 0; i < kAttempts; ++i) {
+        analyzer.addAttempt(randomSheet(rng), score(rng));
+    }
+    std::vector<std::vector<std::string>> candidates;
+    for (size_t i = 0; i < kCandidates; ++i) {
+        candidates.push_back(randomSheet(rng));
+    }
+    
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << kQuestions << " questions, " << kAttempts << " attempts, "
+              << cores << " cores" << std::endl;
+    std::cout << std::setw(10) << "threads"
+              << std::setw(16) << "analysis (ms)"
+              << std::setw(10) << "speedup" << std::endl;
+    
+    std::vector<std::pair<std::string, double>> serialConfidences;
+    std::vector<std::string> serialCommon;
+    std::vector<double> serialScores;
+    double serialMs = 0.0;
+    
+    for (size_t threads = 1; threads <= cores; threads *= 2) {
+        analyzer.setThreadCount(threads);
+        AnswerAnalyzer fresh = analyzer;  // empty caches, shared pool
+        
+        auto start = std::chrono::steady_clock::now();
+        auto confidences = fresh.getAnswerConfidences();
+        auto common = fresh.getMostCommonAnswers();
+        auto scores = fresh.predictScores(candidates);
+        double ms = elapsedMs(start);
+        
+        if (threads == 1) {
+            serialConfidences = confidences;
+            serialCommon = common;
+            serialScores = scores;
+            serialMs = ms;
+        } else if (confidences != serialConfidences || common != serialCommon ||
+                   scores != serialScores) {
+            std::cerr << "Parallel results differ from serial with " << threads
+                      << " threads" << std::endl;
+            return 1;
+        }
+        
+        std::cout << std::setw(10) << threads
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(16) << ms
+                  << std::setw(9) << std::setprecision(2) << serialMs / ms << "x" << std::endl;
+    }
+    
+    return 0;
+}
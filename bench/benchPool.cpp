@@ -0,0 +1,123 @@
+// Benchmark for AnalyzerPool
+//
+// Builds a mixed attempt stream over thousands of tests whose sizes follow a
+// long-tailed distribution, routes it into a pool and analyzes every test,
+// with and without a per-shard memory budget. Also checks that a test
+// callback cannot call back into its pool.
+
+#include "../analyzerPool.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const size_t kTests = 2000;
+const size_t kRecords = 20000;
+const size_t kQuestions = 10;
+const char* const kAlphabet[] = {"a", "b", "c", "d"};
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(7);
+    
+    // A few tests get most of the traffic
+    std::vector<std::vector<std::string>> keys(kTests, std::vector<std::string>(kQuestions));
+    std::vector<double> popularity(kTests);
+    for (size_t t = 0; t < kTests; ++t) {
+        for (auto& answer : keys[t]) {
+            answer = kAlphabet[rng() % 4];
+        }
+        popularity[t] = 1.0 / (t + 1);
+    }
+    std::discrete_distribution<size_t> pickTest(popularity.begin(), popularity.end());
+    
+    std::vector<TaggedAttempt> records;
+    records.reserve(kRecords);
+    for (size_t i = 0; i < kRecords; ++i) {
+        size_t t = pickTest(rng);
+        TaggedAttempt record{"test" + std::to_string(t), std::vector<std::string>(kQuestions), 0.0};
+        size_t correct = 0;
+        for (size_t q = 0; q < kQuestions; ++q) {
+            record.answers[q] = kAlphabet[rng() % 4];
+            correct += record.answers[q] == keys[t][q];
+        }
+        record.percentage = 100.0 * correct / kQuestions;
+        records.push_back(std::move(record));
+    }
+    
+    std::cout << kRecords << " attempts over " << kTests << " tests, "
+              << std::thread::hardware_concurrency() << " cores" << std::endl;
+    std::cout << std::setw(12) << "budget (KB)" << std::setw(10) << "threads"
+              << std::setw(13) << "ingest (ms)" << std::setw(14) << "analyze (ms)"
+              << std::setw(13) << "memory (MB)" << std::setw(10) << "compacted" << std::endl;
+    
+    for (size_t budget : {size_t(0), size_t(128 * 1024)}) {
+        for (size_t threads : {size_t(1), size_t(0)}) {
+            AnalyzerPoolOptions options;
+            options.threads = threads;
+            options.shardMemoryBudget = budget;
+            AnalyzerPool pool(options);
+            
+            auto start = std::chrono::steady_clock::now();
+            IngestStats stats = pool.ingest(records);
+            double ingestMs = elapsedMs(start);
+            
+            start = std::chrono::steady_clock::now();
+            auto reports = pool.analyzeAll();
+            double analyzeMs = elapsedMs(start);
+            
+            size_t compacted = 0;
+            for (const auto& report : reports) {
+                compacted += report.summaryOnly;
+            }
+            if (stats.rejected > 0 || reports.size() != pool.testCount()) {
+                std::cerr << "unexpected result: " << stats.firstError << std::endl;
+                return 1;
+            }
+            
+            std::cout << std::setw(12) << budget / 1024 << std::setw(10) << pool.getThreadCount()
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(13) << ingestMs << std::setw(14) << analyzeMs
+                      << std::setw(13) << pool.memoryUsage() / 1048576.0
+                      << std::setw(10) << compacted << std::endl;
+        }
+    }
+    
+    // A callback that reaches back into the pool must fail rather than deadlock
+    AnalyzerPoolOptions options;
+    options.maxQuestions = kQuestions;
+    AnalyzerPool pool(options);
+    pool.ingest(records);
+    size_t refused = 0;
+    try {
+        pool.forEachTest([&](const std::string&, AnswerAnalyzer&) {
+            pool.addAttempt("other", records.front().answers, 50.0);
+        });
+    } catch (const AnalyzerPoolException&) {
+        refused++;
+    }
+    pool.withTest(records.front().testId, [&](AnswerAnalyzer&) {
+        try {
+            pool.testCount();
+        } catch (const AnalyzerPoolException&) {
+            refused++;
+        }
+    });
+    if (refused != 2) {
+        std::cerr << "a callback was allowed back into its pool" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
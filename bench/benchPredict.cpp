@@ -0,0 +1,145 @@
+// Benchmark for AnswerAnalyzer::predictScore / predictScores
+//
+// Builds synthetic histories of growing size and times a single prediction
+// (including the confidence computation it triggers) and a batch of
+// predictions that reuse the cached confidences. With confidences hoisted
+// out of the similarity loop, doubling the number of attempts should roughly
+// double the time per prediction instead of quadrupling it.
+//
+// A second table compares candidate throughput of the portable matching loop
+// with the SIMD kernel picked at runtime; both must give identical scores.
+
+#include "../answerAnalyzer.h"
+#include "../matchKernel.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kQuestions = 10;
+const char* const kAlphabet[] = {"a", "b", "c", "d"};
+
+std::vector<std::string> randomSheet(std::mt19937& rng) {
+    std::uniform_int_distribution<int> pick(0, 3);
+    std::vector<std::string> sheet;
+    for (size_t q = 0; q < kQuestions; ++q) {
+        sheet.push_back(kAlphabet[pick(rng)]);
+    }
+    return sheet;
+}
+
+void fillAnalyzer(AnswerAnalyzer& analyzer, size_t numAttempts, std::mt19937& rng) {
+    std::vector<std::string> key = randomSheet(rng);
+    for (size_t i = 0; i < numAttempts; ++i) {
+        std::vector<std::string> sheet = randomSheet(rng);
+        size_t correct = 0;
+        for (size_t q = 0; q < kQuestions; ++q) {
+            if (sheet[q] == key[q]) {
+                correct++;
+            }
+        }
+        analyzer.addAttempt(sheet, 100.0 * correct / kQuestions);
+    }
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    const size_t batchSize = 100;
+    
+    std::cout << std::setw(10) << "attempts"
+              << std::setw(16) << "cold (ms)"
+              << std::setw(16) << "warm (ms)"
+              << std::setw(16) << "batch/sheet" << std::endl;
+    
+    double previousCold = 0.0;
+    for (size_t numAttempts = 500; numAttempts <= 16000; numAttempts *= 2) {
+        AnswerAnalyzer analyzer(kQuestions);
+        fillAnalyzer(analyzer, numAttempts, rng);
+        std::vector<std::string> candidate = randomSheet(rng);
+        
+        // Cold: the first prediction also computes the confidences
+        auto start = std::chrono::steady_clock::now();
+        double cold = analyzer.predictScore(candidate);
+        double coldMs = elapsedMs(start);
+        
+        // Warm: confidences are already cached
+        start = std::chrono::steady_clock::now();
+        double warm = analyzer.predictScore(candidate);
+        double warmMs = elapsedMs(start);
+        
+        std::vector<std::vector<std::string>> batch;
+        for (size_t i = 0; i < batchSize; ++i) {
+            batch.push_back(randomSheet(rng));
+        }
+        start = std::chrono::steady_clock::now();
+        std::vector<double> scores = analyzer.predictScores(batch);
+        double batchMs = elapsedMs(start) / batchSize;
+        
+        if (cold != warm || scores.size() != batchSize) {
+            std::cerr << "Inconsistent predictions" << std::endl;
+            return 1;
+        }
+        
+        std::cout << std::setw(10) << numAttempts
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(16) << coldMs
+                  << std::setw(16) << warmMs
+                  << std::setw(16) << batchMs;
+        if (previousCold > 0.0) {
+            std::cout << "   x" << std::setprecision(2) << coldMs / previousCold;
+        }
+        std::cout << std::endl;
+        previousCold = coldMs;
+    }
+    
+    std::cout << "\nmatch kernel: " << matchKernelName() << std::endl;
+    std::cout << std::setw(10) << "attempts"
+              << std::setw(16) << "scalar/s"
+              << std::setw(16) << "simd/s"
+              << std::setw(10) << "speedup" << std::endl;
+    
+    const size_t throughputBatch = 2000;
+    for (size_t numAttempts = 1000; numAttempts <= 64000; numAttempts *= 4) {
+        AnswerAnalyzer analyzer(kQuestions);
+        fillAnalyzer(analyzer, numAttempts, rng);
+        std::vector<std::vector<std::string>> batch;
+        for (size_t i = 0; i < throughputBatch; ++i) {
+            batch.push_back(randomSheet(rng));
+        }
+        analyzer.getAnswerConfidences();
+        
+        useScalarMatchKernel(true);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<double> scalarScores = analyzer.predictScores(batch);
+        double scalarRate = throughputBatch / (elapsedMs(start) / 1000.0);
+        
+        useScalarMatchKernel(false);
+        start = std::chrono::steady_clock::now();
+        std::vector<double> simdScores = analyzer.predictScores(batch);
+        double simdRate = throughputBatch / (elapsedMs(start) / 1000.0);
+        
+        if (scalarScores != simdScores) {
+            std::cerr << "SIMD and scalar predictions differ" << std::endl;
+            return 1;
+        }
+        
+        std::cout << std::setw(10) << numAttempts
+                  << std::fixed << std::setprecision(0)
+                  << std::setw(16) << scalarRate
+                  << std::setw(16) << simdRate
+                  << std::setw(9) << std::setprecision(2) << simdRate / scalarRate << "x" << std::endl;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Benchmark for the EM scorer against the built-in confidence heuristic
+//
+// For short and long synthetic histories with a lot of guessing, counts how
+// many questions each scorer's top answer gets right against the hidden key,
+// and times a cold EM fit against the warm-started refit after one more
+// attempt arrives.
+
+#include "../answerAnalyzer.h"
+#include "../emScorer.h"
+#include "benchTiming.h"
+#include "syntheticAttempts.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const size_t kQuestions = 10;
+const size_t kSeeds = 20;
+
+typedef std::chrono::steady_clock Clock;
+
+size_t keyMatches(const AnswerAnalyzer& analyzer, const std::vector<std::string>& key) {
+    std::vector<std::pair<std::string, double>> confidences;
+    analyzer.getAnswerConfidences(confidences);
+    size_t matches = 0;
+    for (size_t q = 0; q < key.size(); ++q) {
+        matches += confidences[q].first == key[q];
+    }
+    return matches;
+}
+
+}  // namespace
+
+int main() {
+    std::cout << std::setw(10) << "attempts" << std::setw(14) << "heuristic %" << std::setw(10)
+              << "em %" << std::setw(12) << "cold ms" << std::setw(12) << "warm ms"
+              << std::setw(12) << "cold iters" << std::setw(12) << "warm iters" << std::endl;
+
+    for (size_t attempts : {5, 10, 25, 100, 1000, 10000}) {
+        size_t heuristicHits = 0;
+        size_t emHits = 0;
+        double coldMs = 0.0;
+        double warmMs = 0.0;
+        size_t coldIterations = 0;
+        size_t warmIterations = 0;
+
+        for (size_t seed = 1; seed <= kSeeds; ++seed) {
+            SyntheticSpec spec;
+            spec.questions = kQuestions;
+            spec.attempts = attempts + 1;
+            spec.alphabet = 8;
+            spec.noise = 1.0;
+            spec.seed = static_cast<std::uint32_t>(seed);
+            const SyntheticHistory history = generateAttempts(spec);
+
+            AnswerAnalyzer analyzer(kQuestions);
+            for (size_t i = 0; i < attempts; ++i) {
+                analyzer.addAttempt(history.attempts[i], history.percentages[i]);
+            }
+            heuristicHits += keyMatches(analyzer, history.key);
+
+            auto scorer = std::make_shared<EmScorer>();
+            analyzer.setScorer(scorer);
+            Clock::time_point start = Clock::now();
+            emHits += keyMatches(analyzer, history.key);
+            coldMs += elapsedMs(start);
+            coldIterations += scorer->getLastIterations();
+
+            analyzer.addAttempt(history.attempts[attempts], history.percentages[attempts]);
+            start = Clock::now();
+            keyMatches(analyzer, history.key);
+            warmMs += elapsedMs(start);
+            warmIterations += scorer->getLastIterations();
+        }
+
+        const double questions = static_cast<double>(kSeeds * kQuestions);
+        std::cout << std::setw(10) << attempts << std::fixed << std::setprecision(1)
+                  << std::setw(14) << 100.0 * heuristicHits / questions << std::setw(10)
+                  << 100.0 * emHits / questions << std::setprecision(3) << std::setw(12)
+                  << coldMs / kSeeds << std::setw(12) << warmMs / kSeeds << std::setprecision(1)
+                  << std::setw(12) << static_cast<double>(coldIterations) / kSeeds
+                  << std::setw(12) << static_cast<double>(warmIterations) / kSeeds << std::endl;
+    }
+    return 0;
+}
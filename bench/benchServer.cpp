@@ -0,0 +1,89 @@
+// Benchmark for AnalysisServer
+//
+// Starts the server on a temporary Unix socket with a few thousand attempts
+// resident, then drives it with concurrent predict clients, once scoring each
+// predict as it arrives and once with a short batch window.
+
+#include "../analysisServer.h"
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+const size_t kAttempts = 5000;
+const size_t kQuestions = 10;
+const size_t kClients = 16;
+const size_t kRequests = 500;
+const int kWindows[] = {0, 200};
+const char* const kAlphabet[] = {"a", "b", "c", "d"};
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(11);
+    std::vector<std::string> key(kQuestions);
+    for (auto& answer : key) {
+        answer = kAlphabet[rng() % 4];
+    }
+
+    const std::string base = "/tmp/benchServer." + std::to_string(::getpid());
+    const std::string historyFile = base + ".bin";
+    {
+        AnswerAnalyzer analyzer(kQuestions);
+        std::vector<std::string> answers(kQuestions);
+        for (size_t i = 0; i < kAttempts; ++i) {
+            size_t correct = 0;
+            for (size_t q = 0; q < kQuestions; ++q) {
+                answers[q] = kAlphabet[rng() % 4];
+                correct += answers[q] == key[q];
+            }
+            analyzer.addAttempt(answers, 100.0 * correct / kQuestions);
+        }
+        analyzer.saveToFile(historyFile, FileFormat::Binary);
+    }
+
+    std::cout << kAttempts << " resident attempts, " << kClients << " clients x "
+              << kRequests << " predicts" << std::endl;
+    std::cout << std::setw(12) << "window (us)" << std::setw(12) << "req/s"
+              << std::setw(10) << "p50 (us)" << std::setw(10) << "p99 (us)"
+              << std::setw(12) << "per batch" << std::endl;
+
+    for (int window : kWindows) {
+        ServerOptions options;
+        options.address.socketPath = base + ".sock";
+        options.batchWindowUs = window;
+        options.loadFile = historyFile;
+        AnalysisServer server(options);
+        server.listen();
+        std::thread serving([&server]() { server.run(); });
+
+        LoadOptions load;
+        load.address = options.address;
+        load.clients = kClients;
+        load.requestsPerClient = kRequests;
+        load.sheet = key;
+        LoadReport report = runLoadGenerator(load);
+
+        server.stop();
+        serving.join();
+        const double perBatch = server.getBatchCount()
+            ? static_cast<double>(server.getBatchedPredicts()) / server.getBatchCount() : 0.0;
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(12) << window << std::setw(12) << report.throughput
+                  << std::setw(10) << report.p50Us << std::setw(10) << report.p99Us
+                  << std::setw(12) << perBatch;
+        if (report.errors > 0) {
+            std::cout << "  (" << report.errors << " errors)";
+        }
+        std::cout << std::endl;
+    }
+
+    std::remove(historyFile.c_str());
+    return 0;
+}
@@ -0,0 +1,68 @@
+// Benchmark for the interned, column-major attempt storage
+//
+// Fills an AttemptStore with a million synthetic attempts and compares its
+// footprint with the string-per-answer layout it replaced (one
+// std::vector<std::string> per attempt). Also times a full scan that counts
+// every answer of every question.
+
+#include "../attemptStore.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kQuestions = 20;
+const size_t kAttempts = 1000000;
+const char* const kAlphabet[] = {"a", "b", "c", "d", "e"};
+
+double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, 4);
+    
+    AttemptStore store;
+    std::vector<std::string> sheet(kQuestions);
+    for (size_t i = 0; i < kAttempts; ++i) {
+        for (auto& answer : sheet) {
+            answer = kAlphabet[pick(rng)];
+        }
+        store.add(sheet, 100.0 * pick(rng) / 4);
+    }
+    
+    // Old layout: a vector of strings plus a percentage per attempt
+    size_t legacyBytes = kAttempts * (sizeof(std::vector<std::string>) + sizeof(double) +
+                                      kQuestions * sizeof(std::string));
+    size_t storeBytes = store.memoryUsage();
+    
+    auto start = std::chrono::steady_clock::now();
+    std::vector<size_t> counts;
+    size_t checksum = 0;
+    for (size_t q = 0; q < store.numQuestions(); ++q) {
+        counts.assign(store.numAnswers(q), 0);
+        const AttemptStore::AnswerId* column = store.column(q);
+        for (size_t i = 0; i < store.size(); ++i) {
+            counts[column[i]]++;
+        }
+        checksum += counts[0];
+    }
+    double scanMs = elapsedMs(start);
+    
+    std::cout << std::fixed << std::setprecision(1)
+              << "attempts:           " << kAttempts << " x " << kQuestions << " questions\n"
+              << "string layout (MB): " << legacyBytes / 1048576.0 << "\n"
+              << "column store (MB):  " << storeBytes / 1048576.0 << "\n"
+              << "reduction:          x" << static_cast<double>(legacyBytes) / storeBytes << "\n"
+              << "count scan (ms):    " << scanMs << " (checksum " << checksum << ")" << std::endl;
+    
+    return 0;
+}
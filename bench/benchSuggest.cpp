@@ -0,0 +1,112 @@
+// Benchmark for suggestNextAttempt
+//
+// Plays the guessing game against hidden answer keys: each round submits
+// the analyzer's suggestion, scores it against the key and records the
+// attempt, until a sheet scores 100%. Compares the information-gain search
+// with simply resubmitting the top-confidence answers, and reports the
+// number of submissions and the time per suggestion.
+
+#include "../answerAnalyzer.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kQuestions = 10;
+const size_t kTrials = 10;
+const size_t kMaxSubmissions = 40;
+const char* const kAlphabet[] = {"a", "b", "c", "d"};
+
+struct GameResult {
+    double submissions = 0.0;
+    size_t unsolved = 0;
+    double suggestMs = 0.0;
+};
+
+GameResult play(bool useSearch) {
+    GameResult total;
+    size_t suggestions = 0;
+    for (size_t trial = 0; trial < kTrials; ++trial) {
+        std::mt19937 rng(static_cast<unsigned>(trial + 1));
+        std::vector<std::string> key;
+        for (size_t q = 0; q < kQuestions; ++q) {
+            key.push_back(kAlphabet[rng() % 4]);
+        }
+        
+        AnswerAnalyzer analyzer(kQuestions);
+        auto submit = [&](const std::vector<std::string>& sheet) {
+            size_t correct = 0;
+            for (size_t q = 0; q < kQuestions; ++q) {
+                if (sheet[q] == key[q]) {
+                    correct++;
+                }
+            }
+            analyzer.addAttempt(sheet, 100.0 * correct / kQuestions);
+            return correct;
+        };
+        
+        // Two random opening sheets
+        for (int i = 0; i < 2; ++i) {
+            std::vector<std::string> sheet;
+            for (size_t q = 0; q < kQuestions; ++q) {
+                sheet.push_back(kAlphabet[rng() % 4]);
+            }
+            submit(sheet);
+        }
+        
+        size_t submissions = 2;
+        size_t lastScore = 0;
+        while (lastScore < kQuestions && submissions < kMaxSubmissions) {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::string> sheet;
+            if (useSearch) {
+                SuggestionOptions options;
+                options.seed = static_cast<std::uint32_t>(submissions);
+                sheet = analyzer.suggestNextAttempt(options);
+            } else {
+                for (const auto& [answer, confidence] : analyzer.getAnswerConfidences()) {
+                    sheet.push_back(answer);
+                }
+            }
+            total.suggestMs += std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+            suggestions++;
+            
+            lastScore = submit(sheet);
+            submissions++;
+        }
+        if (lastScore < kQuestions) {
+            total.unsolved++;
+        }
+        total.submissions += submissions;
+    }
+    total.submissions /= kTrials;
+    total.suggestMs /= std::max<size_t>(suggestions, 1);
+    return total;
+}
+
+}  // namespace
+
+int main() {
+    std::cout << kQuestions << " questions, 4 choices, " << kTrials
+              << " hidden keys, at most " << kMaxSubmissions << " submissions" << std::endl;
+    std::cout << std::setw(18) << "strategy"
+              << std::setw(14) << "submissions"
+              << std::setw(10) << "unsolved"
+              << std::setw(16) << "ms/suggestion" << std::endl;
+    
+    for (bool useSearch : {false, true}) {
+        GameResult result = play(useSearch);
+        std::cout << std::setw(18) << (useSearch ? "information gain" : "top confidence")
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(14) << result.submissions
+                  << std::setw(10) << result.unsolved
+                  << std::setw(16) << result.suggestMs << std::endl;
+    }
+    
+    return 0;
+}
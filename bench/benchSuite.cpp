@@ -0,0 +1,278 @@
+// Benchmark suite for the analysis hot paths
+//
+// Times addAttempt, getAnswerConfidences (recomputed, and served from its
+// cache), predictScore, suggestNextAttempt, saveToFile and loadFromFile on
+// synthetic histories of several shapes. Each
+// case runs for a growing number of iterations until it has been timed for
+// at least --min-time seconds.
+//
+//   benchSuite [--filter <substring>] [--min-time <seconds>] [--json <file>]
+//
+// --json writes the results in Google Benchmark's JSON layout, so runs from
+// different releases can be compared with the usual tooling ('-' = stdout).
+
+#include "../answerAnalyzer.h"
+#include "../jsonWriter.h"
+#include "benchTiming.h"
+#include "syntheticAttempts.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Keep the compiler from discarding a result that is otherwise unused
+template <typename T>
+void keep(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchCase {
+    std::string name;
+    size_t itemsPerIteration;  // reported as items_per_second when nonzero
+    std::function<void(size_t)> run;  // runs the given number of iterations
+};
+
+struct BenchResult {
+    std::string name;
+    size_t iterations = 0;
+    double realNs = 0.0;  // per iteration
+    double cpuNs = 0.0;
+    double itemsPerSecond = 0.0;
+};
+
+const SyntheticSpec kShapes[] = {
+    // questions, attempts, alphabet, noise
+    {10, 100, 4, 0.3, 1},
+    {50, 1000, 4, 0.3, 2},
+    {20, 500, 8, 0.6, 3},
+    {100, 5000, 4, 0.1, 4},
+};
+
+std::string shapeName(const SyntheticSpec& spec) {
+    std::ostringstream name;
+    name << "Q:" << spec.questions << "/A:" << spec.attempts << "/K:" << spec.alphabet
+         << "/noise:" << spec.noise;
+    return name.str();
+}
+
+void addCases(const SyntheticSpec& spec, const std::string& scratch, std::vector<BenchCase>& cases) {
+    auto history = std::make_shared<SyntheticHistory>(generateAttempts(spec));
+    auto analyzer = std::make_shared<AnswerAnalyzer>(spec.questions);
+    for (size_t i = 0; i < spec.attempts; ++i) {
+        analyzer->addAttempt(history->attempts[i], history->percentages[i]);
+    }
+    const std::string shape = shapeName(spec);
+    const size_t questions = spec.questions;
+
+    // Building a history of A attempts from nothing
+    cases.push_back({"BM_addAttempt/" + shape, spec.attempts, [history, questions](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            AnswerAnalyzer fresh(questions);
+            for (size_t a = 0; a < history->attempts.size(); ++a) {
+                fresh.addAttempt(history->attempts[a], history->percentages[a]);
+            }
+            keep(fresh);
+        }
+    }});
+
+    // Resetting the (absent) scorer only drops the cached confidences, so
+    // every iteration recomputes them from the unchanged history
+    cases.push_back({"BM_getAnswerConfidences/" + shape, 0, [analyzer](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            analyzer->setScorer(nullptr);
+            auto confidences = analyzer->getAnswerConfidences();
+            keep(confidences);
+        }
+    }});
+
+    cases.push_back({"BM_getAnswerConfidences_cached/" + shape, 0, [analyzer](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            auto confidences = analyzer->getAnswerConfidences();
+            keep(confidences);
+        }
+    }});
+
+    cases.push_back({"BM_predictScore/" + shape, 0, [analyzer, history](size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            double score = analyzer->predictScore(history->key);
+            keep(score);
+        }
+    }});
+
+    cases.push_back({"BM_suggestNextAttempt/" + shape, 0, [analyzer](size_t n) {
+        SuggestionOptions options;
+        options.maxIterations = 2000;
+        for (size_t i = 0; i < n; ++i) {
+            auto suggestion = analyzer->suggestNextAttempt(options);
+            keep(suggestion);
+        }
+    }});
+
+    for (FileFormat format : {FileFormat::Text, FileFormat::Binary}) {
+        const std::string suffix = format == FileFormat::Text ? "text" : "binary";
+        const std::string file = scratch + "." + std::to_string(spec.seed) + "." + suffix;
+
+        cases.push_back({"BM_saveToFile/" + suffix + "/" + shape, spec.attempts,
+                         [analyzer, file, format](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                analyzer->saveToFile(file, format);
+            }
+            std::remove(file.c_str());
+        }});
+
+        cases.push_back({"BM_loadFromFile/" + suffix + "/" + shape, spec.attempts,
+                         [analyzer, file, format, questions](size_t n) {
+            analyzer->saveToFile(file, format);
+            AnswerAnalyzer loaded(questions);
+            for (size_t i = 0; i < n; ++i) {
+                loaded.loadFromFile(file);
+                keep(loaded);
+            }
+            std::remove(file.c_str());
+        }});
+    }
+}
+
+BenchResult measure(const BenchCase& bench, double minSeconds) {
+    BenchResult result;
+    result.name = bench.name;
+
+    bench.run(1);  // warm caches and lazily built indexes
+    size_t iterations = 1;
+    for (;;) {
+        const std::clock_t cpuStart = std::clock();
+        const auto start = std::chrono::steady_clock::now();
+        bench.run(iterations);
+        const double seconds = elapsedMs(start) / 1e3;
+        const double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+        if (seconds >= minSeconds || iterations >= (size_t(1) << 30)) {
+            result.iterations = iterations;
+            result.realNs = seconds * 1e9 / iterations;
+            result.cpuNs = cpuSeconds * 1e9 / iterations;
+            if (bench.itemsPerIteration > 0 && seconds > 0.0) {
+                result.itemsPerSecond = bench.itemsPerIteration * iterations / seconds;
+            }
+            return result;
+        }
+        // Aim a little past the target, as Google Benchmark does
+        const double scale = seconds > 0.0 ? 1.4 * minSeconds / seconds : 10.0;
+        iterations = static_cast<size_t>(iterations * std::min(10.0, std::max(2.0, scale)));
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<BenchResult>& results, const char* executable) {
+    char host[256] = "";
+    ::gethostname(host, sizeof(host) - 1);
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+
+    out << std::setprecision(10) << "{\n  \"context\": {\n    \"date\": ";
+    writeJsonString(out, date);
+    out << ",\n    \"host_name\": ";
+    writeJsonString(out, host);
+    out << ",\n    \"executable\": ";
+    writeJsonString(out, executable);
+    out << ",\n    \"num_cpus\": " << std::thread::hardware_concurrency()
+        << "\n  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& result = results[i];
+        out << (i > 0 ? "," : "") << "\n    {\n      \"name\": ";
+        writeJsonString(out, result.name);
+        out << ",\n      \"run_name\": ";
+        writeJsonString(out, result.name);
+        out << ",\n      \"run_type\": \"iteration\",\n      \"repetitions\": 1"
+            << ",\n      \"repetition_index\": 0,\n      \"threads\": 1"
+            << ",\n      \"iterations\": " << result.iterations
+            << ",\n      \"real_time\": " << result.realNs
+            << ",\n      \"cpu_time\": " << result.cpuNs
+            << ",\n      \"time_unit\": \"ns\"";
+        if (result.itemsPerSecond > 0.0) {
+            out << ",\n      \"items_per_second\": " << result.itemsPerSecond;
+        }
+        out << "\n    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    std::string jsonFile;
+    double minSeconds = 0.05;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (i + 1 < argc && arg == "--filter") {
+            filter = argv[++i];
+        } else if (i + 1 < argc && arg == "--min-time") {
+            minSeconds = std::stod(argv[++i]);
+        } else if (i + 1 < argc && arg == "--json") {
+            jsonFile = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--filter <substring>] [--min-time <seconds>] [--json <file>]" << std::endl;
+            return 2;
+        }
+    }
+
+    const std::string scratch = "/tmp/benchSuite." + std::to_string(::getpid());
+    std::vector<BenchCase> cases;
+    for (const SyntheticSpec& spec : kShapes) {
+        addCases(spec, scratch, cases);
+    }
+
+    // The table goes to stderr when the JSON takes stdout
+    std::ostream& table = jsonFile == "-" ? std::cerr : std::cout;
+    table << std::left << std::setw(58) << "benchmark" << std::right << std::setw(14) << "time (ns)"
+          << std::setw(14) << "cpu (ns)" << std::setw(12) << "iterations" << std::setw(14)
+          << "items/s" << std::endl;
+
+    std::vector<BenchResult> results;
+    for (const BenchCase& bench : cases) {
+        if (bench.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        BenchResult result = measure(bench, minSeconds);
+        table << std::left << std::setw(58) << result.name << std::right << std::fixed
+              << std::setprecision(0) << std::setw(14) << result.realNs << std::setw(14)
+              << result.cpuNs << std::setw(12) << result.iterations << std::setw(14);
+        if (result.itemsPerSecond > 0.0) {
+            table << result.itemsPerSecond;
+        } else {
+            table << "";
+        }
+        table << std::endl;
+        results.push_back(result);
+    }
+
+    if (jsonFile == "-") {
+        writeJson(std::cout, results, argv[0]);
+    } else if (!jsonFile.empty()) {
+        std::ofstream out(jsonFile);
+        writeJson(out, results, argv[0]);
+        if (!out) {
+            std::cerr << "Cannot write " << jsonFile << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,14 @@
+#ifndef BENCH_TIMING_H
+#define BENCH_TIMING_H
+
+// Wall-clock timing shared by the benchmarks
+
+#include <chrono>
+
+// Milliseconds of wall time since start
+inline double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+#endif
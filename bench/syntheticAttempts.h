@@ -0,0 +1,66 @@
+#ifndef SYNTHETIC_ATTEMPTS_H
+#define SYNTHETIC_ATTEMPTS_H
+
+// Synthetic attempt histories for the benchmarks. A hidden key is drawn over
+// an alphabet of the requested size; every attempt answers each question
+// correctly with the attempt's own skill, otherwise with a uniformly random
+// letter, and is scored exactly against the key.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+struct SyntheticSpec {
+    size_t questions = 10;
+    size_t attempts = 100;
+    size_t alphabet = 4;       // distinct answers per question
+    double noise = 0.5;        // mean share of answers guessed at random
+    std::uint32_t seed = 1;
+};
+
+struct SyntheticHistory {
+    std::vector<std::string> key;
+    std::vector<std::vector<std::string>> attempts;
+    std::vector<double> percentages;
+};
+
+// Answer letters "a", "b", ..., then "a1", "b1", ... past the 26th
+inline std::string syntheticAnswer(size_t index) {
+    std::string answer(1, static_cast<char>('a' + index % 26));
+    if (index >= 26) {
+        answer += std::to_string(index / 26);
+    }
+    return answer;
+}
+
+inline SyntheticHistory generateAttempts(const SyntheticSpec& spec) {
+    std::mt19937 rng(spec.seed);
+    std::uniform_int_distribution<size_t> pickAnswer(0, spec.alphabet - 1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    SyntheticHistory history;
+    for (size_t q = 0; q < spec.questions; ++q) {
+        history.key.push_back(syntheticAnswer(pickAnswer(rng)));
+    }
+
+    history.attempts.reserve(spec.attempts);
+    history.percentages.reserve(spec.attempts);
+    for (size_t i = 0; i < spec.attempts; ++i) {
+        // Skill varies between attempts around 1 - noise
+        const double guessing = std::min(1.0, 2.0 * spec.noise * unit(rng));
+        std::vector<std::string> sheet(spec.questions);
+        size_t correct = 0;
+        for (size_t q = 0; q < spec.questions; ++q) {
+            sheet[q] = unit(rng) < guessing ? syntheticAnswer(pickAnswer(rng)) : history.key[q];
+            correct += sheet[q] == history.key[q];
+        }
+        history.attempts.push_back(std::move(sheet));
+        history.percentages.push_back(100.0 * correct / spec.questions);
+    }
+    return history;
+}
+
+#endif
@@ -0,0 +1,189 @@
+#include "bulkGrader.h"
+#include "caseFold.h"
+#include "threadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedSeconds(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Comma-separated answers; a trailing comma adds an empty last answer
+void splitSheet(const std::string& line, std::vector<std::string>& answers) {
+    answers.clear();
+    size_t start = 0;
+    while (true) {
+        const size_t comma = line.find(',', start);
+        if (comma == std::string::npos) {
+            answers.emplace_back(line, start);
+            return;
+        }
+        answers.emplace_back(line, start, comma - start);
+        start = comma + 1;
+    }
+}
+
+}  // namespace
+
+BulkGrader::BulkGrader(const std::vector<std::string>& answerKey,
+                       const BulkGraderOptions& graderOptions)
+    : options(graderOptions), foldedKey(answerKey) {
+    if (foldedKey.empty()) {
+        throw BulkGraderException("Answer key cannot be empty");
+    }
+    if (foldedKey.size() > options.maxQuestions) {
+        throw BulkGraderException("Answer key has more than " +
+                                  std::to_string(options.maxQuestions) + " questions");
+    }
+    if (options.chunkSize == 0) {
+        throw BulkGraderException("Chunk size must be positive");
+    }
+    for (std::string& answer : foldedKey) {
+        foldCase(answer);
+    }
+
+    size_t threads = options.threads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (threads > 1) {
+        threadPool = std::make_shared<ThreadPool>(threads);
+    }
+}
+
+BulkGrader::~BulkGrader() = default;
+
+size_t BulkGrader::getThreadCount() const {
+    return threadPool ? threadPool->size() : 1;
+}
+
+std::string BulkGrader::checkSheet(const std::vector<std::string>& answers) const {
+    if (answers.size() != foldedKey.size()) {
+        return "expected " + std::to_string(foldedKey.size()) + " answers, got " +
+               std::to_string(answers.size());
+    }
+    for (const std::string& answer : answers) {
+        if (answer.size() > options.maxAnswerLength) {
+            return "answer longer than " + std::to_string(options.maxAnswerLength) + " characters";
+        }
+    }
+    return std::string();
+}
+
+double BulkGrader::score(const std::vector<std::string>& answers) const {
+    size_t correct = 0;
+    for (size_t q = 0; q < foldedKey.size(); ++q) {
+        correct += equalsIgnoreCase(answers[q], foldedKey[q]);
+    }
+    return 100.0 * correct / foldedKey.size();
+}
+
+// Sheets are cheap and uniform, so plain chunks of a few hundred suffice
+void BulkGrader::forEachSheet(size_t count, const std::function<void(size_t, size_t)>& body) const {
+    if (threadPool) {
+        threadPool->parallelFor(count, 256, body);
+    } else if (count > 0) {
+        body(0, count);
+    }
+}
+
+double BulkGrader::grade(const std::vector<std::string>& answers) const {
+    std::string error = checkSheet(answers);
+    if (!error.empty()) {
+        throw BulkGraderException("Invalid sheet: " + error);
+    }
+    return score(answers);
+}
+
+void BulkGrader::gradeAll(std::vector<TestAttempt>& sheets) {
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < sheets.size(); ++i) {
+        std::string error = checkSheet(sheets[i].answers);
+        if (!error.empty()) {
+            throw BulkGraderException("Sheet " + std::to_string(i + 1) + ": " + error);
+        }
+    }
+
+    forEachSheet(sheets.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            sheets[i].percentage = score(sheets[i].answers);
+        }
+    });
+    stats.sheets += sheets.size();
+    stats.seconds += elapsedSeconds(start);
+}
+
+void BulkGrader::gradeStream(std::istream& in,
+                             const std::function<void(std::vector<TestAttempt>&)>& sink) {
+    std::vector<std::string> lines;
+    std::vector<size_t> lineNumbers;
+    std::vector<std::string> errors;
+    std::vector<TestAttempt> chunk;
+    std::string line;
+    size_t lineNumber = 0;
+    lines.reserve(options.chunkSize);
+    lineNumbers.reserve(options.chunkSize);
+
+    while (true) {
+        const Clock::time_point start = Clock::now();
+
+        // Reading is serial; splitting and grading the chunk is not
+        lines.clear();
+        lineNumbers.clear();
+        while (lines.size() < options.chunkSize && std::getline(in, line)) {
+            lineNumber++;
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                lines.push_back(std::move(line));
+                lineNumbers.push_back(lineNumber);
+            }
+        }
+        if (lines.empty()) {
+            break;
+        }
+
+        chunk.clear();
+        for (size_t i = 0; i < lines.size(); ++i) {
+            chunk.emplace_back(std::vector<std::string>(), 0.0);
+        }
+        errors.assign(lines.size(), std::string());
+        forEachSheet(lines.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                splitSheet(lines[i], chunk[i].answers);
+                errors[i] = checkSheet(chunk[i].answers);
+                if (errors[i].empty()) {
+                    chunk[i].percentage = score(chunk[i].answers);
+                }
+            }
+        });
+
+        // Drop rejected sheets, keeping the rest in input order
+        size_t kept = 0;
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            if (!errors[i].empty()) {
+                if (stats.rejected++ == 0) {
+                    stats.firstError = "Line " + std::to_string(lineNumbers[i]) + ": " + errors[i];
+                }
+                continue;
+            }
+            if (kept != i) {
+                chunk[kept] = std::move(chunk[i]);
+            }
+            kept++;
+        }
+        chunk.erase(chunk.begin() + kept, chunk.end());
+        stats.sheets += kept;
+        stats.seconds += elapsedSeconds(start);
+
+        if (!chunk.empty()) {
+            sink(chunk);
+        }
+    }
+}
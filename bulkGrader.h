@@ -0,0 +1,79 @@
+#ifndef BULK_GRADER_H
+#define BULK_GRADER_H
+
+#include "answerAnalyzer.h"
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Custom exception class for BulkGrader-specific errors
+class BulkGraderException : public std::runtime_error {
+public:
+    explicit BulkGraderException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+struct BulkGraderOptions {
+    size_t maxQuestions = 10000;    // longest answer key accepted
+    size_t maxAnswerLength = 100;   // a longer answer rejects its sheet
+    size_t threads = 0;             // 0 = one per core
+    size_t chunkSize = 4096;        // sheets read, graded and handed on at a time
+};
+
+// Running totals of a grader, for throughput reporting
+struct GradingStats {
+    size_t sheets = 0;          // graded
+    size_t rejected = 0;        // streamed sheets that failed validation
+    std::string firstError;     // reason for the first rejection, by stream order
+    double seconds = 0.0;       // spent grading, including reading streams
+
+    double sheetsPerSecond() const { return seconds > 0.0 ? sheets / seconds : 0.0; }
+};
+
+// Grades many answer sheets against one key. Answers are compared ignoring
+// ASCII case, as in AnswerTracker, and a sheet's percentage is
+// 100 * correct / questions. Graded sheets come out as TestAttempts, ready
+// for AnswerAnalyzer::addAttempts.
+//
+// Sheets are graded in parallel on a thread pool; each sheet is graded by
+// exactly one thread, so results do not depend on the thread count.
+class BulkGrader {
+private:
+    BulkGraderOptions options;
+    std::vector<std::string> foldedKey;
+    std::shared_ptr<ThreadPool> threadPool;
+    GradingStats stats;
+
+    // Empty if the sheet can be graded, otherwise why not
+    std::string checkSheet(const std::vector<std::string>& answers) const;
+    double score(const std::vector<std::string>& answers) const;
+    void forEachSheet(size_t count, const std::function<void(size_t, size_t)>& body) const;
+
+public:
+    explicit BulkGrader(const std::vector<std::string>& answerKey,
+                        const BulkGraderOptions& graderOptions = BulkGraderOptions());
+    ~BulkGrader();
+
+    // Core functionality
+    double grade(const std::vector<std::string>& answers) const;
+    // Set every sheet's percentage; throws before grading anything if a
+    // sheet is invalid
+    void gradeAll(std::vector<TestAttempt>& sheets);
+    // Read one comma-separated sheet per line, skipping blank lines, and
+    // hand the graded sheets to sink a chunk at a time in input order.
+    // Invalid sheets are left out and counted in the stats.
+    void gradeStream(std::istream& in, const std::function<void(std::vector<TestAttempt>&)>& sink);
+    void resetStats() { stats = GradingStats(); }
+
+    // Getters
+    const GradingStats& getStats() const { return stats; }
+    size_t getNumQuestions() const { return foldedKey.size(); }
+    size_t getThreadCount() const;
+    const BulkGraderOptions& getOptions() const { return options; }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "caseFold.h"
+
+#if defined(__SSE2__)
+#define CASE_FOLD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+inline char foldByte(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+#ifdef CASE_FOLD_SSE2
+
+// Shift 'A'..'Z' to the bottom of the signed byte range so one signed
+// comparison finds them, then add 0x20 to exactly those bytes
+inline __m128i foldBlock(__m128i bytes) {
+    const __m128i shifted = _mm_add_epi8(bytes, _mm_set1_epi8(static_cast<char>(0x80 - 'A')));
+    const __m128i upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(0x80 + 26)));
+    return _mm_add_epi8(bytes, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A')));
+}
+
+#endif
+
+}  // namespace
+
+void foldCase(std::string& text) {
+    char* data = text.data();
+    const size_t size = text.size();
+    size_t i = 0;
+#ifdef CASE_FOLD_SSE2
+    for (; i + 16 <= size; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), foldBlock(block));
+    }
+#endif
+    for (; i < size; ++i) {
+        data[i] = foldByte(data[i]);
+    }
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    const size_t size = a.size();
+    size_t i = 0;
+#ifdef CASE_FOLD_SSE2
+    for (; i + 16 <= size; i += 16) {
+        __m128i left = foldBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a.data() + i)));
+        __m128i right = foldBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b.data() + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(left, right)) != 0xFFFF) {
+            return false;
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (foldByte(a[i]) != foldByte(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
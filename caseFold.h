@@ -0,0 +1,18 @@
+#ifndef CASE_FOLD_H
+#define CASE_FOLD_H
+
+#include <string>
+#include <string_view>
+
+// ASCII case folding for answer comparison. Only 'A'..'Z' are folded; every
+// other byte, including each byte of a multi-byte UTF-8 sequence, is kept
+// as it is, so folded UTF-8 stays valid and compares as before. Both
+// functions work sixteen bytes at a time where SSE2 is available.
+
+// Lowercase text in place
+void foldCase(std::string& text);
+
+// Whether a and b are equal once folded, without allocating
+bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+#endif
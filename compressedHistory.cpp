@@ -0,0 +1,412 @@
+#include "compressedHistory.h"
+#include "lzBlock.h"
+#include "mappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+namespace {
+
+const char kCompressedMagic[8] = {'A', 'N', 'S', 'W', 'R', 'C', 'M', 'P'};
+const std::uint32_t kLzFlag = 1;
+const size_t kHeaderBytes = 48;
+
+void putU32(std::string& out, std::uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out += static_cast<char>((value >> shift) & 0xFF);
+    }
+}
+
+void putU64(std::string& out, std::uint64_t value) {
+    putU32(out, static_cast<std::uint32_t>(value));
+    putU32(out, static_cast<std::uint32_t>(value >> 32));
+}
+
+void putVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+// Bounds-checked reads from one section of the file; any overrun marks the
+// reader failed instead of throwing, and the caller checks once per item
+class ByteReader {
+private:
+    const unsigned char* data;
+    size_t pos;
+    size_t end;
+    bool failed;
+
+public:
+    ByteReader(const char* bytes, size_t begin, size_t limit)
+        : data(reinterpret_cast<const unsigned char*>(bytes)), pos(begin), end(limit),
+          failed(begin > limit) {}
+
+    std::uint32_t u32() {
+        if (end - pos < 4 || failed) {
+            failed = true;
+            return 0;
+        }
+        std::uint32_t value = 0;
+        for (int i = 3; i >= 0; --i) {
+            value = (value << 8) | data[pos + i];
+        }
+        pos += 4;
+        return value;
+    }
+
+    std::uint64_t u64() {
+        const std::uint64_t low = u32();
+        return low | (std::uint64_t(u32()) << 32);
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64 && !failed; shift += 7) {
+            if (pos >= end) {
+                break;
+            }
+            const unsigned char byte = data[pos++];
+            value |= std::uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        failed = true;
+        return 0;
+    }
+
+    const char* bytes(size_t count) {
+        if (end - pos < count || failed) {
+            failed = true;
+            return nullptr;
+        }
+        const char* start = reinterpret_cast<const char*>(data + pos);
+        pos += count;
+        return start;
+    }
+
+    bool ok() const { return !failed; }
+    bool atEnd() const { return pos == end; }
+    size_t position() const { return pos; }
+};
+
+// Raw encoding of attempts [first, last) of the store, see the header
+void encodeBlock(const AttemptStore& store, size_t first, size_t last,
+                 const std::map<std::uint64_t, std::uint32_t>& scoreIndex, std::string& out) {
+    const size_t numQuestions = store.numQuestions();
+    std::vector<size_t> changed;
+    for (size_t i = first; i < last; ++i) {
+        double score = store.percentage(i);
+        std::uint64_t bits;
+        std::memcpy(&bits, &score, sizeof(bits));
+        putVarint(out, scoreIndex.at(bits));
+
+        changed.clear();
+        for (size_t q = 0; q < numQuestions; ++q) {
+            const AttemptStore::AnswerId previous = i == first ? 0 : store.answerId(q, i - 1);
+            if (store.answerId(q, i) != previous) {
+                changed.push_back(q);
+            }
+        }
+        putVarint(out, changed.size());
+        size_t next = 0;
+        for (size_t q : changed) {
+            putVarint(out, q - next);
+            putVarint(out, store.answerId(q, i));
+            next = q + 1;
+        }
+    }
+}
+
+}  // namespace
+
+bool CompressedHistory::isCompressedFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(kCompressedMagic)];
+    return file.read(magic, sizeof(magic)) &&
+           std::memcmp(magic, kCompressedMagic, sizeof(magic)) == 0;
+}
+
+void CompressedHistory::write(const AttemptStore& store, std::ostream& out,
+                              const CompressionOptions& options) {
+    if (!store.retainsAttempts() && !store.empty()) {
+        throw CompressedHistoryException("A summary-only store has no attempts to write");
+    }
+    if (options.blockAttempts == 0 || options.blockAttempts > UINT32_MAX) {
+        throw CompressedHistoryException("Attempts per block must be between 1 and 2^32 - 1");
+    }
+    const size_t numQuestions = store.numQuestions();
+    const size_t blockCount = (store.size() + options.blockAttempts - 1) / options.blockAttempts;
+
+    std::string head;
+    for (size_t q = 0; q < numQuestions; ++q) {
+        putVarint(head, store.numAnswers(q));
+        for (size_t id = 0; id < store.numAnswers(q); ++id) {
+            const std::string& answer = store.answerText(q, static_cast<AttemptStore::AnswerId>(id));
+            putVarint(head, answer.size());
+            head += answer;
+        }
+    }
+
+    // Scores repeat far more than answers do, so they get a dictionary too
+    std::map<std::uint64_t, std::uint32_t> scoreIndex;
+    std::string scoreTable;
+    for (size_t i = 0; i < store.size(); ++i) {
+        double score = store.percentage(i);
+        std::uint64_t bits;
+        std::memcpy(&bits, &score, sizeof(bits));
+        if (scoreIndex.emplace(bits, static_cast<std::uint32_t>(scoreIndex.size())).second) {
+            putU64(scoreTable, bits);
+        }
+    }
+    putVarint(head, scoreIndex.size());
+    head += scoreTable;
+
+    std::string body;
+    std::string index;
+    std::string raw;
+    size_t offset = kHeaderBytes + head.size();
+    for (size_t b = 0; b < blockCount; ++b) {
+        const size_t first = b * options.blockAttempts;
+        const size_t last = std::min(store.size(), first + options.blockAttempts);
+        raw.clear();
+        encodeBlock(store, first, last, scoreIndex, raw);
+        if (raw.size() > UINT32_MAX) {
+            throw CompressedHistoryException("Block too large; use fewer attempts per block");
+        }
+
+        const size_t start = body.size();
+        if (options.lz) {
+            lzCompressBlock(raw.data(), raw.size(), body);
+        }
+        if (!options.lz || body.size() - start >= raw.size()) {
+            body.resize(start);
+            body += raw;
+        }
+        putU64(index, offset + start);
+        putU32(index, static_cast<std::uint32_t>(body.size() - start));
+        putU32(index, static_cast<std::uint32_t>(raw.size()));
+    }
+
+    std::string header(kCompressedMagic, sizeof(kCompressedMagic));
+    putU32(header, kVersion);
+    putU32(header, options.lz ? kLzFlag : 0);
+    putU64(header, numQuestions);
+    putU64(header, store.size());
+    putU32(header, static_cast<std::uint32_t>(options.blockAttempts));
+    putU32(header, static_cast<std::uint32_t>(blockCount));
+    putU64(header, offset + body.size());
+
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    out.write(head.data(), static_cast<std::streamsize>(head.size()));
+    out.write(body.data(), static_cast<std::streamsize>(body.size()));
+    out.write(index.data(), static_cast<std::streamsize>(index.size()));
+}
+
+CompressedHistory::CompressedHistory(const std::string& path)
+    : filename(path), questionCount(0), attemptCount(0), blockAttempts(0),
+      currentBlock(SIZE_MAX), rawData(nullptr), rawPosition(0), decodedAttempts(0),
+      sheetScore(0) {
+    try {
+        file = std::make_shared<const MappedFile>(path);
+    } catch (const MappedFileException& e) {
+        throw CompressedHistoryException(e.what());
+    }
+    const char* data = file->data();
+    const size_t fileSize = file->size();
+    if (fileSize < kHeaderBytes ||
+        std::memcmp(data, kCompressedMagic, sizeof(kCompressedMagic)) != 0) {
+        throw CompressedHistoryException("Not a compressed attempt file: " + path);
+    }
+
+    ByteReader header(data, sizeof(kCompressedMagic), kHeaderBytes);
+    const std::uint32_t version = header.u32();
+    if (version != kVersion) {
+        throw CompressedHistoryException("Unsupported compressed attempt file version " +
+                                         std::to_string(version) + ": " + path);
+    }
+    header.u32();  // flags; each block records whether it was compressed
+    const std::uint64_t questions = header.u64();
+    const std::uint64_t attempts = header.u64();
+    const std::uint32_t perBlock = header.u32();
+    const std::uint32_t blockCount = header.u32();
+    const std::uint64_t indexOffset = header.u64();
+    // Every block but the last is full and the last is not empty; written
+    // without rounding up, which would overflow for a crafted count
+    const bool blocksFit = blockCount == 0
+        ? attempts == 0
+        : attempts > std::uint64_t(blockCount - 1) * perBlock &&
+          attempts <= std::uint64_t(blockCount) * perBlock;
+    if (perBlock == 0 || !blocksFit ||
+        indexOffset > fileSize || (fileSize - indexOffset) != std::uint64_t(blockCount) * 16 ||
+        questions > fileSize) {
+        throw corrupt();
+    }
+    questionCount = questions;
+    attemptCount = attempts;
+    blockAttempts = perBlock;
+
+    ByteReader head(data, kHeaderBytes, indexOffset);
+    answerTexts.resize(questionCount);
+    for (size_t q = 0; q < questionCount; ++q) {
+        const std::uint64_t count = head.varint();
+        if (!head.ok() || count >= AttemptStore::kNoAnswer) {
+            throw corrupt();
+        }
+        answerTexts[q].reserve(count);
+        for (std::uint64_t id = 0; id < count; ++id) {
+            const std::uint64_t length = head.varint();
+            const char* bytes = head.bytes(length);
+            if (!head.ok()) {
+                throw corrupt();
+            }
+            answerTexts[q].emplace_back(bytes, length);
+        }
+        // Unchanged answers start from id 0, which must exist
+        if (count == 0 && attemptCount > 0) {
+            throw corrupt();
+        }
+    }
+    const std::uint64_t scoreCount = head.varint();
+    if (!head.ok() || scoreCount > fileSize / 8) {
+        throw corrupt();
+    }
+    scores.reserve(scoreCount);
+    for (std::uint64_t s = 0; s < scoreCount; ++s) {
+        const std::uint64_t bits = head.u64();
+        double score;
+        std::memcpy(&score, &bits, sizeof(score));
+        scores.push_back(score);
+    }
+    if (!head.ok()) {
+        throw corrupt();
+    }
+
+    // An attempt takes two varints at least and an LZ sequence expands to
+    // at most 255 bytes per input byte, so the blocks' stored sizes bound
+    // the attempts they can claim and nothing is sized from the header alone
+    ByteReader index(data, indexOffset, fileSize);
+    blocks.reserve(blockCount);
+    std::uint64_t rawTotal = 0;
+    for (std::uint32_t b = 0; b < blockCount; ++b) {
+        Block block;
+        block.offset = index.u64();
+        block.storedBytes = index.u32();
+        block.rawBytes = index.u32();
+        const std::uint64_t inBlock = std::min<std::uint64_t>(blockAttempts, attemptCount - b * blockAttempts);
+        if (!index.ok() || block.offset > indexOffset ||
+            block.storedBytes > indexOffset - block.offset || block.storedBytes > block.rawBytes ||
+            block.rawBytes > std::uint64_t(block.storedBytes) * 255 + 16 ||
+            block.rawBytes < 2 * inBlock) {
+            throw corrupt();
+        }
+        rawTotal += block.rawBytes;
+        blocks.push_back(block);
+    }
+    if (attemptCount > rawTotal / 2) {
+        throw corrupt();
+    }
+}
+
+CompressedHistoryException CompressedHistory::corrupt() const {
+    return CompressedHistoryException("Corrupt compressed attempt file: " + filename);
+}
+
+void CompressedHistory::loadBlock(size_t b) const {
+    currentBlock = SIZE_MAX;
+    const Block& block = blocks[b];
+    const char* stored = file->data() + block.offset;
+    rawData = stored;
+    if (block.storedBytes != block.rawBytes) {
+        rawBlock.resize(block.rawBytes);
+        if (!lzDecompressBlock(stored, block.storedBytes, &rawBlock[0], block.rawBytes)) {
+            throw corrupt();
+        }
+        rawData = rawBlock.data();
+    }
+    rawPosition = 0;
+    decodedAttempts = 0;
+    sheet.assign(questionCount, 0);
+    currentBlock = b;
+}
+
+void CompressedHistory::seek(size_t attempt) const {
+    if (attempt >= attemptCount) {
+        throw CompressedHistoryException("Attempt index out of range");
+    }
+    const size_t b = attempt / blockAttempts;
+    const size_t target = attempt % blockAttempts + 1;  // attempts to have decoded
+    if (b != currentBlock || decodedAttempts > target) {
+        loadBlock(b);
+    }
+
+    ByteReader reader(rawData, rawPosition, blocks[b].rawBytes);
+    while (decodedAttempts < target) {
+        const std::uint64_t score = reader.varint();
+        const std::uint64_t changes = reader.varint();
+        if (!reader.ok() || score >= scores.size() || changes > questionCount) {
+            throw corrupt();
+        }
+        size_t q = 0;
+        for (std::uint64_t c = 0; c < changes; ++c) {
+            const std::uint64_t gap = reader.varint();
+            const std::uint64_t id = reader.varint();
+            if (!reader.ok() || gap >= questionCount - q || id >= answerTexts[q + gap].size()) {
+                throw corrupt();
+            }
+            q += gap;
+            sheet[q++] = static_cast<AttemptStore::AnswerId>(id);
+        }
+        sheetScore = static_cast<std::uint32_t>(score);
+        decodedAttempts++;
+    }
+    rawPosition = reader.position();
+
+    // The last attempt of a block must end it exactly
+    const size_t inBlock = std::min(blockAttempts, attemptCount - b * blockAttempts);
+    if (decodedAttempts == inBlock && !reader.atEnd()) {
+        throw corrupt();
+    }
+}
+
+std::vector<std::string> CompressedHistory::answers(size_t attempt) const {
+    seek(attempt);
+    std::vector<std::string> result;
+    result.reserve(questionCount);
+    for (size_t q = 0; q < questionCount; ++q) {
+        result.push_back(answerTexts[q][sheet[q]]);
+    }
+    return result;
+}
+
+double CompressedHistory::percentage(size_t attempt) const {
+    seek(attempt);
+    return scores[sheetScore];
+}
+
+AttemptStore::AnswerId CompressedHistory::answerId(size_t q, size_t attempt) const {
+    if (q >= questionCount) {
+        throw CompressedHistoryException("Question index out of range");
+    }
+    seek(attempt);
+    return sheet[q];
+}
+
+AttemptStore CompressedHistory::toStore() const {
+    AttemptStore store;
+    for (size_t i = 0; i < attemptCount; ++i) {
+        try {
+            store.add(answers(i), percentage(i));
+        } catch (const AttemptStoreException& e) {
+            throw CompressedHistoryException(e.what());
+        }
+        if (i == 0) {
+            store.reserve(attemptCount);
+        }
+    }
+    return store;
+}
@@ -0,0 +1,102 @@
+#ifndef COMPRESSED_HISTORY_H
+#define COMPRESSED_HISTORY_H
+
+#include "attemptStore.h"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Custom exception class for CompressedHistory-specific errors
+class CompressedHistoryException : public std::runtime_error {
+public:
+    explicit CompressedHistoryException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+struct CompressionOptions {
+    size_t blockAttempts = 256;  // attempts per block, the unit of random access
+    bool lz = true;               // LZ-compress blocks where that makes them smaller
+};
+
+// Compressed attempt files. Consecutive attempts usually change only a few
+// answers, so each one is stored as its differences from the attempt
+// before it. Integers are little-endian; varints are LEB128.
+//
+//   header:       8-byte magic, u32 version, u32 flags (1 = LZ blocks),
+//                 u64 questions, u64 attempts, u32 attempts per block,
+//                 u32 blocks, u64 offset of the block index
+//   answers:      per question a varint count, then per answer a varint
+//                 length and the bytes; an answer's id is its position
+//   scores:       varint count, then each distinct score as an f64
+//   blocks:       see below, LZ-compressed (lzBlock.h) unless that would
+//                 not make them smaller
+//   block index:  per block u64 offset, u32 stored bytes, u32 raw bytes
+//
+// Within a block every attempt is a varint score index, a varint count of
+// changed questions and, per change in question order, the varint gap
+// from the previous change and the varint answer id. The first attempt of
+// a block is compared with a sheet of id 0 answers, so any block decodes
+// on its own and reading attempt i costs one block at most; reading in
+// order costs only the changes.
+class CompressedHistory {
+private:
+    struct Block {
+        std::uint64_t offset;
+        std::uint32_t storedBytes;  // equal to rawBytes if not compressed
+        std::uint32_t rawBytes;
+    };
+
+    std::string filename;
+    std::shared_ptr<const MappedFile> file;
+    size_t questionCount;
+    size_t attemptCount;
+    size_t blockAttempts;
+    std::vector<std::vector<std::string>> answerTexts;  // [question][id]
+    std::vector<double> scores;
+    std::vector<Block> blocks;
+
+    // Decoding position: the raw bytes of one block and the sheet of the
+    // last attempt decoded from it, so reading forward only applies the
+    // changes in between. Reads are not thread-safe.
+    mutable size_t currentBlock;
+    mutable std::string rawBlock;             // decompressed block, if it was compressed
+    mutable const char* rawData;
+    mutable size_t rawPosition;
+    mutable size_t decodedAttempts;           // decoded from the current block
+    mutable std::vector<AttemptStore::AnswerId> sheet;  // [question]
+    mutable std::uint32_t sheetScore;         // index into scores
+
+    void loadBlock(size_t block) const;
+    void seek(size_t attempt) const;  // make sheet hold this attempt
+    CompressedHistoryException corrupt() const;
+
+public:
+    // Version written to and accepted from compressed files
+    static const std::uint32_t kVersion = 1;
+
+    // Maps the file and reads its dictionaries and block index
+    explicit CompressedHistory(const std::string& path);
+
+    // Core functionality
+    static bool isCompressedFile(const std::string& path);
+    static void write(const AttemptStore& store, std::ostream& out,
+                      const CompressionOptions& options = CompressionOptions());
+    std::vector<std::string> answers(size_t attempt) const;
+    double percentage(size_t attempt) const;
+    AttemptStore::AnswerId answerId(size_t q, size_t attempt) const;
+    AttemptStore toStore() const;  // decode every attempt
+
+    // Getters
+    size_t size() const { return attemptCount; }
+    bool empty() const { return attemptCount == 0; }
+    size_t numQuestions() const { return questionCount; }
+    size_t numBlocks() const { return blocks.size(); }
+    size_t numAnswers(size_t q) const { return answerTexts[q].size(); }
+    const std::string& answerText(size_t q, AttemptStore::AnswerId id) const { return answerTexts[q][id]; }
+};
+
+#endif
@@ -0,0 +1,792 @@
+#include "deductionEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <set>
+
+namespace {
+
+// Arithmetic modulo the Mersenne prime 2^31 - 1; products fit in 64 bits
+const std::uint64_t kPrime = 2147483647;
+
+// Dense elimination needs columns^2 words, so wide systems skip it; 1024
+// columns keep the basis under 9 MB
+const size_t kMaxLinearColumns = 1024;
+
+std::uint64_t modPow(std::uint64_t base, std::uint64_t exponent) {
+    std::uint64_t result = 1;
+    base %= kPrime;
+    while (exponent) {
+        if (exponent & 1) {
+            result = result * base % kPrime;
+        }
+        base = base * base % kPrime;
+        exponent >>= 1;
+    }
+    return result;
+}
+
+std::uint64_t modInverse(std::uint64_t value) {
+    return modPow(value, kPrime - 2);
+}
+
+const size_t kNoQuestion = static_cast<size_t>(-1);
+
+// A search node costs roughly questions + attempts; the default budget keeps
+// an unresolved solve well under a second
+const size_t kDefaultWork = 2500000;
+const size_t kMinNodeBudget = 1000;
+
+// A multiply-add in the linear elimination costs about a hundredth of a
+// unit of search work
+const size_t kFieldOpsPerWork = 100;
+
+}  // namespace
+
+DeductionEngine::DeductionEngine(std::vector<std::vector<std::uint32_t>> options,
+                                 const std::vector<std::uint32_t>& optionCounts,
+                                 std::vector<size_t> correctTargets)
+    : optionOf(std::move(options)), targets(std::move(correctTargets)),
+      nodes(0), nodeBudget(0), exhausted(false), orderNoise(0.0) {
+    nodeBudget = std::max(kMinNodeBudget, kDefaultWork / (numQuestions() + numAttempts() + 1));
+    matchingAttempts.resize(numQuestions());
+    alive.resize(numQuestions());
+    aliveCount.resize(numQuestions());
+    for (size_t q = 0; q < numQuestions(); ++q) {
+        matchingAttempts[q].resize(optionCounts[q]);
+        for (size_t i = 0; i < numAttempts(); ++i) {
+            matchingAttempts[q][optionOf[q][i]].push_back(static_cast<std::uint32_t>(i));
+        }
+        alive[q].assign(optionCounts[q], 1);
+        aliveCount[q] = optionCounts[q];
+    }
+
+    correctCount.assign(numAttempts(), 0);
+    openCount.assign(numAttempts(), 0);
+    for (size_t q = 0; q < numQuestions(); ++q) {
+        bool decided = aliveCount[q] == 1;
+        for (size_t i = 0; i < numAttempts(); ++i) {
+            if (decided) {
+                correctCount[i]++;
+            } else {
+                openCount[i]++;
+            }
+        }
+    }
+    queued.assign(numAttempts(), 0);
+}
+
+void DeductionEngine::enqueue(std::uint32_t attempt) {
+    if (!queued[attempt]) {
+        queued[attempt] = 1;
+        queue.push_back(attempt);
+    }
+}
+
+void DeductionEngine::clearQueue() {
+    for (std::uint32_t attempt : queue) {
+        queued[attempt] = 0;
+    }
+    queue.clear();
+}
+
+std::uint32_t DeductionEngine::singleOption(size_t q) const {
+    auto it = std::find(alive[q].begin(), alive[q].end(), 1);
+    return static_cast<std::uint32_t>(it - alive[q].begin());
+}
+
+bool DeductionEngine::removeOption(std::uint32_t q, std::uint32_t option) {
+    if (!alive[q][option]) {
+        return true;
+    }
+    if (aliveCount[q] == 1) {
+        return false;  // the last possible answer cannot go
+    }
+
+    // Attempts that chose the removed option are now known to be wrong here
+    alive[q][option] = 0;
+    aliveCount[q]--;
+    for (std::uint32_t i : matchingAttempts[q][option]) {
+        openCount[i]--;
+        enqueue(i);
+    }
+
+    // and with one option left, the attempts that chose it are right
+    bool madeSingleton = aliveCount[q] == 1;
+    if (madeSingleton) {
+        for (std::uint32_t i : matchingAttempts[q][singleOption(q)]) {
+            openCount[i]--;
+            correctCount[i]++;
+            enqueue(i);
+        }
+    }
+
+    trail.push_back({q, option, madeSingleton});
+    return true;
+}
+
+bool DeductionEngine::restrictTo(std::uint32_t q, std::uint32_t option) {
+    if (!alive[q][option]) {
+        return false;
+    }
+    for (std::uint32_t other = 0; other < alive[q].size(); ++other) {
+        if (other != option && !removeOption(q, other)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DeductionEngine::undoTo(size_t trailSize) {
+    while (trail.size() > trailSize) {
+        Removal removal = trail.back();
+        trail.pop_back();
+
+        if (removal.madeSingleton) {
+            for (std::uint32_t i : matchingAttempts[removal.question][singleOption(removal.question)]) {
+                openCount[i]++;
+                correctCount[i]--;
+            }
+        }
+        alive[removal.question][removal.option] = 1;
+        aliveCount[removal.question]++;
+        for (std::uint32_t i : matchingAttempts[removal.question][removal.option]) {
+            openCount[i]++;
+        }
+    }
+}
+
+// An attempt that already has all its correct answers is wrong on every
+// undecided question; one that needs all of them is right on every one
+bool DeductionEngine::propagateAttempt(std::uint32_t i) {
+    long target = static_cast<long>(targets[i]);
+    if (correctCount[i] > target || correctCount[i] + openCount[i] < target) {
+        return false;
+    }
+    if (openCount[i] == 0) {
+        return true;
+    }
+
+    bool allIncorrect = correctCount[i] == target;
+    bool allCorrect = correctCount[i] + openCount[i] == target;
+    if (!allIncorrect && !allCorrect) {
+        return true;
+    }
+
+    for (std::uint32_t q = 0; q < numQuestions() && openCount[i] > 0; ++q) {
+        std::uint32_t option = optionOf[q][i];
+        if (!alive[q][option] || aliveCount[q] == 1) {
+            continue;
+        }
+        bool ok = allIncorrect ? removeOption(q, option) : restrictTo(q, option);
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DeductionEngine::propagate() {
+    while (!queue.empty()) {
+        std::uint32_t i = queue.back();
+        queue.pop_back();
+        queued[i] = 0;
+        if (!propagateAttempt(i)) {
+            clearQueue();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every question has exactly one correct option (counting the untried one)
+// and every attempt row x(q, chosen option) summed over q equals its target.
+// The rows are reduced incrementally to reduced row echelon form modulo a
+// prime; a pivot variable whose row has no free columns left takes the same
+// value in every integer solution, so it is fixed before any search.
+//
+// The elimination is charged to the node budget, a node being worth
+// kFieldOpsPerWork field operations per question and attempt. Once it has
+// used half the budget it stops, keeping what it fixed so far, and
+// propagation and search settle the rest.
+bool DeductionEngine::applyLinearConstraints() {
+    std::vector<std::vector<size_t>> columnOf(numQuestions());
+    size_t numColumns = 0;
+    for (size_t q = 0; q < numQuestions(); ++q) {
+        for (size_t o = 0; o < alive[q].size(); ++o) {
+            columnOf[q].push_back(numColumns++);
+        }
+    }
+    if (numColumns == 0 || numColumns > kMaxLinearColumns) {
+        return true;
+    }
+
+    const size_t nodeCost = kFieldOpsPerWork * (numQuestions() + numAttempts() + 1);
+    const size_t workLimit = nodeBudget / 2 > SIZE_MAX / nodeCost ? SIZE_MAX
+                                                                  : nodeBudget / 2 * nodeCost;
+    size_t work = 0;
+    auto withinBudget = [&](size_t operations) {
+        work += operations;
+        if (work <= workLimit) {
+            return true;
+        }
+        nodes += work / nodeCost;
+        return false;
+    };
+
+    const size_t rhs = numColumns;
+    std::vector<std::vector<std::uint64_t>> basis;
+    std::vector<long> pivotRow(numColumns, -1);
+    std::vector<size_t> freeColumns(numColumns);
+    std::iota(freeColumns.begin(), freeColumns.end(), 0);
+    std::vector<std::uint64_t> row(numColumns + 1, 0);
+
+    // No attempt picks a question's untried option. Adding 1 to each of q's
+    // tried options and taking their count off its untried one therefore
+    // keeps q's row unchanged and raises every attempt row by exactly 1, so
+    // the difference of two such moves cancels in every row. That gives
+    // Q - 1 independent null vectors once attempts exist, and the rank
+    // never exceeds numColumns - (Q - 1); stop there, the search still
+    // checks the remaining attempts.
+    const size_t minFree = numAttempts() > 0 ? numQuestions() - 1 : 0;
+
+    // Rows [0, Q) are the one-answer-per-question rows, the rest are attempts
+    std::vector<size_t> entries;
+    for (size_t r = 0; r < numQuestions() + numAttempts() && freeColumns.size() > minFree; ++r) {
+        if (!withinBudget(numQuestions())) {
+            return true;
+        }
+        entries.clear();
+        if (r < numQuestions()) {
+            entries = columnOf[r];
+            row[rhs] = 1;
+        } else {
+            size_t i = r - numQuestions();
+            for (size_t q = 0; q < numQuestions(); ++q) {
+                entries.push_back(columnOf[q][optionOf[q][i]]);
+            }
+            row[rhs] = targets[i] % kPrime;
+        }
+        for (size_t column : entries) {
+            row[column] = 1;
+        }
+
+        // Eliminate the pivot columns; basis rows only have entries in free
+        // columns besides their own pivot
+        for (size_t column : entries) {
+            if (pivotRow[column] < 0) {
+                continue;
+            }
+            if (!withinBudget(freeColumns.size())) {
+                return true;
+            }
+            std::uint64_t coefficient = row[column];
+            row[column] = 0;
+            const auto& pivot = basis[pivotRow[column]];
+            for (size_t f : freeColumns) {
+                row[f] = (row[f] + kPrime - coefficient * pivot[f] % kPrime) % kPrime;
+            }
+            row[rhs] = (row[rhs] + kPrime - coefficient * pivot[rhs] % kPrime) % kPrime;
+        }
+
+        auto newPivot = std::find_if(freeColumns.begin(), freeColumns.end(),
+                                     [&row](size_t f) { return row[f] != 0; });
+        if (newPivot == freeColumns.end()) {
+            if (row[rhs] != 0) {
+                return false;  // contradicts earlier attempts
+            }
+            continue;
+        }
+
+        // Normalize the new row and clear its pivot column from the basis
+        if (!withinBudget(numColumns + basis.size() * freeColumns.size())) {
+            return true;
+        }
+        size_t pivotColumn = *newPivot;
+        std::uint64_t inverse = modInverse(row[pivotColumn]);
+        std::vector<std::uint64_t> pivot(numColumns + 1, 0);
+        for (size_t f : freeColumns) {
+            pivot[f] = row[f] * inverse % kPrime;
+            row[f] = 0;
+        }
+        pivot[rhs] = row[rhs] * inverse % kPrime;
+        row[rhs] = 0;
+
+        for (auto& other : basis) {
+            std::uint64_t coefficient = other[pivotColumn];
+            if (coefficient == 0) {
+                continue;
+            }
+            for (size_t f : freeColumns) {
+                other[f] = (other[f] + kPrime - coefficient * pivot[f] % kPrime) % kPrime;
+            }
+            other[rhs] = (other[rhs] + kPrime - coefficient * pivot[rhs] % kPrime) % kPrime;
+        }
+
+        freeColumns.erase(newPivot);
+        pivotRow[pivotColumn] = static_cast<long>(basis.size());
+        basis.push_back(std::move(pivot));
+    }
+
+    // Attempts pick exactly one option per question, so the system never sees
+    // mass moved between whole questions and single variables are rarely
+    // determined. Differences within a question are: the functional
+    // x(q,o) - x(q,first) is determined when its free-column coefficients
+    // cancel after substituting the pivot rows.
+    std::vector<std::uint64_t> coefficients(numColumns, 0);
+    auto difference = [&](size_t plus, size_t minus, std::uint64_t& value) {
+        value = 0;
+        for (auto [column, sign] : {std::make_pair(plus, std::uint64_t(1)),
+                                    std::make_pair(minus, kPrime - 1)}) {
+            if (pivotRow[column] < 0) {
+                coefficients[column] = (coefficients[column] + sign) % kPrime;
+                continue;
+            }
+            const auto& pivot = basis[pivotRow[column]];
+            value = (value + sign * pivot[rhs]) % kPrime;
+            for (size_t f : freeColumns) {
+                coefficients[f] = (coefficients[f] + kPrime - sign * pivot[f] % kPrime) % kPrime;
+            }
+        }
+        bool determined = true;
+        for (size_t f : freeColumns) {
+            determined = determined && coefficients[f] == 0;
+            coefficients[f] = 0;
+        }
+        return determined;
+    };
+
+    for (std::uint32_t q = 0; q < numQuestions(); ++q) {
+        // Only tried options have attempts; the last option is the untried one
+        for (std::uint32_t o = 1; o + 1 < columnOf[q].size(); ++o) {
+            if (!withinBudget(3 * freeColumns.size())) {
+                return true;
+            }
+            std::uint64_t value = 0;
+            if (!difference(columnOf[q][o], columnOf[q][0], value)) {
+                continue;
+            }
+
+            // With at most one correct option, +1/-1 pins the answer and 0
+            // means neither is correct
+            bool ok = true;
+            if (value == 1) {
+                ok = restrictTo(q, o);
+            } else if (value == kPrime - 1) {
+                ok = restrictTo(q, 0);
+            } else if (value == 0) {
+                ok = removeOption(q, o) && removeOption(q, 0);
+            } else {
+                ok = false;  // only fractional solutions exist
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+    }
+    nodes += work / nodeCost;
+    return true;
+}
+
+// Branch on the undecided question with the fewest options left; questions
+// whose remaining options nobody chose cannot affect any attempt
+size_t DeductionEngine::chooseQuestion() const {
+    size_t best = kNoQuestion;
+    for (size_t q = 0; q < numQuestions(); ++q) {
+        if (aliveCount[q] < 2 || (best != kNoQuestion && aliveCount[q] >= aliveCount[best])) {
+            continue;
+        }
+        for (size_t o = 0; o < alive[q].size(); ++o) {
+            if (alive[q][o] && !matchingAttempts[q][o].empty()) {
+                best = q;
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+// Order options by how well they fit the attempts' remaining needs: an
+// undecided attempt that still needs c of its o open answers votes for its own
+// option with the log-odds of c/o
+std::vector<std::uint32_t> DeductionEngine::orderOptions(size_t q) {
+    std::vector<std::pair<double, std::uint32_t>> scored;
+    for (std::uint32_t o = 0; o < alive[q].size(); ++o) {
+        if (!alive[q][o]) {
+            continue;
+        }
+        double fit = 0.0;
+        for (std::uint32_t i : matchingAttempts[q][o]) {
+            double need = (static_cast<double>(targets[i]) - correctCount[i]) / openCount[i];
+            fit += std::log(need + 1e-9) - std::log(1.0 - need + 1e-9);
+        }
+        if (orderNoise > 0.0) {
+            // Gumbel noise turns the order into a random draw biased by fit
+            double u = std::uniform_real_distribution<double>(1e-12, 1.0)(random);
+            fit += orderNoise * -std::log(-std::log(u));
+        }
+        scored.emplace_back(fit, o);
+    }
+    std::stable_sort(scored.begin(), scored.end(),
+        [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::vector<std::uint32_t> order;
+    for (const auto& [fit, option] : scored) {
+        order.push_back(option);
+    }
+    return order;
+}
+
+// Depth-first search for one consistent key; on success the state is left
+// at the model so the caller can read it before undoing
+bool DeductionEngine::findModel() {
+    if (++nodes > nodeBudget) {
+        exhausted = true;
+        return false;
+    }
+
+    size_t q = chooseQuestion();
+    if (q == kNoQuestion) {
+        return true;
+    }
+
+    for (std::uint32_t option : orderOptions(q)) {
+        size_t mark = trail.size();
+        if (restrictTo(static_cast<std::uint32_t>(q), option) && propagate() && findModel()) {
+            return true;
+        }
+        clearQueue();
+        undoTo(mark);
+        if (exhausted) {
+            return false;
+        }
+    }
+    return false;
+}
+
+void DeductionEngine::countModels(DeductionResult& result, double& count) {
+    if (++nodes > nodeBudget) {
+        exhausted = true;
+        return;
+    }
+
+    size_t q = chooseQuestion();
+    if (q == kNoQuestion) {
+        recordModel(result);
+        count += 1.0;
+        return;
+    }
+
+    for (std::uint32_t option = 0; option < alive[q].size() && !exhausted; ++option) {
+        if (!alive[q][option]) {
+            continue;
+        }
+        size_t mark = trail.size();
+        if (restrictTo(static_cast<std::uint32_t>(q), option) && propagate()) {
+            countModels(result, count);
+        }
+        clearQueue();
+        undoTo(mark);
+    }
+}
+
+void DeductionEngine::collectModels(std::vector<std::vector<std::uint32_t>>& models, size_t limit) {
+    if (++nodes > nodeBudget) {
+        exhausted = true;
+        return;
+    }
+
+    size_t q = chooseQuestion();
+    if (q == kNoQuestion) {
+        if (models.size() == limit) {
+            exhausted = true;  // one too many
+            return;
+        }
+        models.emplace_back(numQuestions());
+        for (size_t question = 0; question < numQuestions(); ++question) {
+            models.back()[question] = singleOption(question);
+        }
+        return;
+    }
+
+    for (std::uint32_t option = 0; option < alive[q].size() && !exhausted; ++option) {
+        if (!alive[q][option]) {
+            continue;
+        }
+        size_t mark = trail.size();
+        if (restrictTo(static_cast<std::uint32_t>(q), option) && propagate()) {
+            collectModels(models, limit);
+        }
+        clearQueue();
+        undoTo(mark);
+    }
+}
+
+// A complete key: every question has exactly one option left
+void DeductionEngine::recordModel(DeductionResult& result) const {
+    for (size_t q = 0; q < numQuestions(); ++q) {
+        result.possible[q][singleOption(q)] = true;
+    }
+}
+
+// Root: linear elimination, then propagate every attempt once. False if no
+// key fits every attempt.
+bool DeductionEngine::prepareRoot() {
+    for (size_t i = 0; i < numAttempts(); ++i) {
+        enqueue(static_cast<std::uint32_t>(i));
+    }
+    if (!applyLinearConstraints() || !propagate()) {
+        clearQueue();
+        undoTo(0);
+        return false;
+    }
+    return true;
+}
+
+DeductionResult DeductionEngine::solve() {
+    DeductionResult result;
+    result.possible.resize(numQuestions());
+    for (size_t q = 0; q < numQuestions(); ++q) {
+        result.possible[q].assign(alive[q].size(), false);
+    }
+
+    nodes = 0;
+    if (!prepareRoot()) {
+        result.countExact = true;
+        result.complete = true;
+        return result;  // no key fits every attempt
+    }
+    const size_t rootMark = trail.size();
+
+    // Count models outright when there are few; half the budget at most,
+    // counting the root's elimination
+    const size_t budget = nodeBudget;
+    nodeBudget = budget / 2;
+    exhausted = false;
+    double count = 0.0;
+    countModels(result, count);
+    undoTo(rootMark);
+    result.modelCount = count;
+    result.countExact = !exhausted;
+    if (result.countExact) {
+        undoTo(0);
+        result.complete = true;
+        nodeBudget = budget;
+        return result;
+    }
+
+    // Otherwise probe every option not yet seen in a model, each with a
+    // slice of the remaining budget. A refuted option is removed at the
+    // root, which narrows the following probes.
+    result.complete = true;
+    for (size_t q = 0; q < numQuestions(); ++q) {
+        for (std::uint32_t option = 0; option < alive[q].size(); ++option) {
+            if (!alive[q][option] || result.possible[q][option]) {
+                continue;
+            }
+
+            size_t mark = trail.size();
+            nodeBudget = std::min(budget, nodes + std::max<size_t>(budget / 20, 1));
+            exhausted = nodes >= budget;
+            bool found = !exhausted && restrictTo(static_cast<std::uint32_t>(q), option) &&
+                         propagate() && findModel();
+            if (found) {
+                recordModel(result);
+            }
+            clearQueue();
+            undoTo(mark);
+
+            if (!found && exhausted) {
+                result.possible[q][option] = true;  // could not rule it out
+                result.complete = false;
+            } else if (!found && (!removeOption(static_cast<std::uint32_t>(q), option) || !propagate())) {
+                // Refuting every remaining option means nothing fits after all
+                clearQueue();
+                undoTo(0);
+                nodeBudget = budget;
+                for (auto& options : result.possible) {
+                    std::fill(options.begin(), options.end(), false);
+                }
+                result.modelCount = 0.0;
+                result.countExact = true;
+                result.complete = true;
+                return result;
+            }
+        }
+    }
+
+    nodeBudget = budget;
+    undoTo(0);
+    return result;
+}
+
+// Min-conflicts local search from a random key over the options still alive:
+// repeatedly pick an attempt with the wrong number of correct answers and
+// change one of its questions, preferring the change that lowers the total
+// error most. Backtracking thrashes when the attempts leave very many keys
+// possible; this finds one of them quickly.
+bool DeductionEngine::localSearchModel(std::vector<std::uint32_t>& key, size_t maxFlips) {
+    key.assign(numQuestions(), 0);
+    std::vector<long> matches(numAttempts(), 0);
+    for (size_t q = 0; q < numQuestions(); ++q) {
+        std::vector<std::uint32_t> options;
+        for (std::uint32_t o = 0; o < alive[q].size(); ++o) {
+            if (alive[q][o]) {
+                options.push_back(o);
+            }
+        }
+        key[q] = options[random() % options.size()];
+        for (std::uint32_t i : matchingAttempts[q][key[q]]) {
+            matches[i]++;
+        }
+    }
+
+    // Attempts whose match count is off, with their positions for O(1) updates
+    std::vector<std::uint32_t> violated;
+    std::vector<long> position(numAttempts(), -1);
+    auto refresh = [&](std::uint32_t i) {
+        bool wrong = matches[i] != static_cast<long>(targets[i]);
+        if (wrong && position[i] < 0) {
+            position[i] = static_cast<long>(violated.size());
+            violated.push_back(i);
+        } else if (!wrong && position[i] >= 0) {
+            std::uint32_t last = violated.back();
+            violated[position[i]] = last;
+            position[last] = position[i];
+            violated.pop_back();
+            position[i] = -1;
+        }
+    };
+    for (std::uint32_t i = 0; i < numAttempts(); ++i) {
+        refresh(i);
+    }
+
+    auto errorChange = [&](size_t q, std::uint32_t to) {
+        long change = 0;
+        for (std::uint32_t i : matchingAttempts[q][key[q]]) {
+            long target = static_cast<long>(targets[i]);
+            change += std::labs(matches[i] - 1 - target) - std::labs(matches[i] - target);
+        }
+        for (std::uint32_t i : matchingAttempts[q][to]) {
+            long target = static_cast<long>(targets[i]);
+            change += std::labs(matches[i] + 1 - target) - std::labs(matches[i] - target);
+        }
+        return change;
+    };
+
+    const size_t maxCandidates = 8;
+    std::vector<std::pair<size_t, std::uint32_t>> candidates;
+    for (size_t flip = 0; flip < maxFlips && !violated.empty(); ++flip) {
+        std::uint32_t i = violated[random() % violated.size()];
+        bool needMore = matches[i] < static_cast<long>(targets[i]);
+
+        // Moves that bring attempt i closer: adopt its answer somewhere it
+        // is wrong, or drop its answer somewhere it is right
+        candidates.clear();
+        for (size_t q = 0; q < numQuestions(); ++q) {
+            std::uint32_t chosen = optionOf[q][i];
+            if (needMore && key[q] != chosen && alive[q][chosen]) {
+                candidates.emplace_back(q, chosen);
+            } else if (!needMore && key[q] == chosen && aliveCount[q] > 1) {
+                std::uint32_t other;
+                do {
+                    other = static_cast<std::uint32_t>(random() % alive[q].size());
+                } while (other == chosen || !alive[q][other]);
+                candidates.emplace_back(q, other);
+            }
+        }
+        if (candidates.empty()) {
+            return false;  // attempt i cannot be satisfied from here
+        }
+
+        // Greedy over a few random candidates, with an occasional random walk
+        std::shuffle(candidates.begin(), candidates.end(), random);
+        size_t pick = 0;
+        if (random() % 10 != 0) {
+            long bestChange = 0;
+            for (size_t c = 0; c < candidates.size() && c < maxCandidates; ++c) {
+                long change = errorChange(candidates[c].first, candidates[c].second);
+                if (c == 0 || change < bestChange) {
+                    bestChange = change;
+                    pick = c;
+                }
+            }
+        }
+
+        auto [q, to] = candidates[pick];
+        for (std::uint32_t attempt : matchingAttempts[q][key[q]]) {
+            matches[attempt]--;
+            refresh(attempt);
+        }
+        key[q] = to;
+        for (std::uint32_t attempt : matchingAttempts[q][to]) {
+            matches[attempt]++;
+            refresh(attempt);
+        }
+    }
+    return violated.empty();
+}
+
+std::vector<std::vector<std::uint32_t>> DeductionEngine::sampleModels(size_t count, std::uint32_t seed) {
+    std::vector<std::vector<std::uint32_t>> models;
+    nodes = 0;
+    if (count == 0 || !prepareRoot()) {
+        return models;
+    }
+    const size_t rootMark = trail.size();
+
+    // Each draw is a fresh noisy descent from the root with its own slice of
+    // the budget, falling back to local search when the descent fails; a
+    // flip costs about as much as a node. Duplicates are dropped.
+    const size_t budget = nodeBudget;
+    random.seed(seed);
+    orderNoise = 1.0;
+    std::set<std::vector<std::uint32_t>> seen;
+    std::vector<std::uint32_t> key;
+    for (size_t draw = 0; draw < count * 4 && models.size() < count && nodes < budget; ++draw) {
+        size_t slice = std::max<size_t>(budget / count, 1);
+        nodeBudget = std::min(budget, nodes + slice);
+        exhausted = false;
+        bool found = findModel();
+        if (found) {
+            key.resize(numQuestions());
+            for (size_t q = 0; q < numQuestions(); ++q) {
+                key[q] = singleOption(q);
+            }
+        }
+        clearQueue();
+        undoTo(rootMark);
+
+        if (!found) {
+            // The first key is worth a larger share: later ones only refine
+            size_t flips = models.empty() ? std::max(slice, budget / 4) : slice;
+            found = localSearchModel(key, flips);
+            nodes += flips;
+        }
+        if (found && seen.insert(key).second) {
+            models.push_back(key);
+        }
+    }
+
+    orderNoise = 0.0;
+    nodeBudget = budget;
+    undoTo(0);
+    return models;
+}
+
+bool DeductionEngine::enumerateModels(size_t limit, std::vector<std::vector<std::uint32_t>>& models) {
+    models.clear();
+    nodes = 0;
+    if (!prepareRoot()) {
+        return true;  // no key fits every attempt
+    }
+    exhausted = false;
+    collectModels(models, limit);
+    clearQueue();
+    undoTo(0);
+    if (exhausted) {
+        models.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,96 @@
+#ifndef DEDUCTION_ENGINE_H
+#define DEDUCTION_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Outcome of an exact deduction over all recorded attempts
+struct DeductionResult {
+    // possible[q][o]: option o of question q is the correct answer in some
+    // consistent key, or could not be ruled out within the search budget.
+    // The last option of each question stands for an answer nobody has tried.
+    std::vector<std::vector<bool>> possible;
+    double modelCount = 0.0;  // answer keys consistent with every attempt
+    bool countExact = false;  // false if modelCount is only a lower bound
+    bool complete = false;    // false if some option was neither confirmed nor refuted
+};
+
+// Small pseudo-boolean solver for answer keys. Variable x(q,o) says option o
+// is the correct answer to question q; at most one tried option per question
+// is correct, and every attempt is the cardinality constraint "exactly k of
+// the options I chose are correct". Solving combines exact linear elimination
+// over a prime field, counter-based propagation and backtracking search, so it
+// has no limit on the number of questions.
+class DeductionEngine {
+private:
+    // A removed option, recorded so the search can undo it
+    struct Removal {
+        std::uint32_t question;
+        std::uint32_t option;
+        bool madeSingleton;  // the removal left a single option
+    };
+
+    std::vector<std::vector<std::uint32_t>> optionOf;                   // [q][attempt]
+    std::vector<std::vector<std::vector<std::uint32_t>>> matchingAttempts;  // [q][option]
+    std::vector<size_t> targets;                                        // correct answers per attempt
+
+    std::vector<std::vector<char>> alive;  // [q][option] still possible
+    std::vector<std::uint32_t> aliveCount;
+    std::vector<long> correctCount;        // per attempt: questions decided correct
+    std::vector<long> openCount;           // per attempt: questions not yet decided
+    std::vector<Removal> trail;
+    std::vector<std::uint32_t> queue;
+    std::vector<char> queued;
+
+    size_t nodes;
+    size_t nodeBudget;
+    bool exhausted;
+    std::mt19937 random;
+    double orderNoise;  // > 0 perturbs the value order to sample diverse keys
+
+    size_t numQuestions() const { return optionOf.size(); }
+    size_t numAttempts() const { return targets.size(); }
+
+    bool prepareRoot();
+    bool applyLinearConstraints();
+    bool removeOption(std::uint32_t q, std::uint32_t option);
+    bool restrictTo(std::uint32_t q, std::uint32_t option);
+    bool propagate();
+    bool propagateAttempt(std::uint32_t attempt);
+    void undoTo(size_t trailSize);
+    void enqueue(std::uint32_t attempt);
+    void clearQueue();
+
+    size_t chooseQuestion() const;
+    std::vector<std::uint32_t> orderOptions(size_t q);
+    std::uint32_t singleOption(size_t q) const;
+    bool findModel();
+    void countModels(DeductionResult& result, double& count);
+    void collectModels(std::vector<std::vector<std::uint32_t>>& models, size_t limit);
+    bool localSearchModel(std::vector<std::uint32_t>& key, size_t maxFlips);
+    void recordModel(DeductionResult& result) const;
+
+public:
+    // optionOf[q][i] is the option attempt i chose for question q, in
+    // [0, optionCounts[q] - 1); the last option is the untried answer.
+    // targets[i] is the number of questions attempt i got right.
+    DeductionEngine(std::vector<std::vector<std::uint32_t>> options,
+                    const std::vector<std::uint32_t>& optionCounts,
+                    std::vector<size_t> correctTargets);
+
+    void setNodeBudget(size_t budget) { nodeBudget = budget; }
+    DeductionResult solve();
+
+    // Up to count distinct consistent keys (key[q] = option), found by
+    // randomized search within the node budget. Not uniformly distributed,
+    // but diverse enough to stand in for the set of consistent keys.
+    std::vector<std::vector<std::uint32_t>> sampleModels(size_t count, std::uint32_t seed);
+
+    // Every consistent key, or false if there are more than limit of them or
+    // the node budget ran out first
+    bool enumerateModels(size_t limit, std::vector<std::vector<std::uint32_t>>& models);
+};
+
+#endif
@@ -0,0 +1,208 @@
+#include "emScorer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+EmScorer::EmScorer(const EmScorerOptions& scorerOptions)
+    : options(scorerOptions), fittedAttempts(0), lastIterations(0), lastConverged(false) {
+    if (options.scoreNoise <= 0.0 || options.scoreNoise >= 1.0) {
+        throw EmScorerException("Score noise must be strictly between 0 and 1");
+    }
+    if (options.damping < 0.0 || options.damping >= 1.0) {
+        throw EmScorerException("Damping must be in [0, 1)");
+    }
+    if (options.unseenWeight < 0.0) {
+        throw EmScorerException("Unseen answer weight must not be negative");
+    }
+}
+
+void EmScorer::reset() {
+    posterior.clear();
+    fittedAttempts = 0;
+    lastIterations = 0;
+    lastConverged = false;
+}
+
+// Initial posterior: the prior for a history never seen before, otherwise
+// the last fit, with answers that appeared since splitting the mass that
+// was on "unseen" evenly with it
+void EmScorer::startFrom(const AttemptStore& attempts) {
+    const size_t numQuestions = attempts.numQuestions();
+    if (posterior.size() != numQuestions || attempts.size() < fittedAttempts) {
+        posterior.clear();
+    }
+
+    if (posterior.empty()) {
+        posterior.resize(numQuestions);
+        for (size_t q = 0; q < numQuestions; ++q) {
+            const size_t answers = attempts.numAnswers(q);
+            const double total = answers + options.unseenWeight;
+            posterior[q].assign(answers + 1, 1.0 / total);
+            posterior[q][answers] = options.unseenWeight / total;
+        }
+        return;
+    }
+
+    for (size_t q = 0; q < numQuestions; ++q) {
+        std::vector<double>& belief = posterior[q];
+        const size_t known = belief.size() - 1;
+        const size_t answers = attempts.numAnswers(q);
+        if (answers == known) {
+            continue;
+        }
+        const double unseen = belief[known];
+        const double share = unseen / (answers - known + 1);
+        belief.resize(answers + 1);
+        std::fill(belief.begin() + known, belief.end(), share);
+    }
+}
+
+// One damped fixed-point step over every question; returns the largest
+// change of any probability
+double EmScorer::sweep(const AttemptStore& attempts) {
+    const size_t numQuestions = attempts.numQuestions();
+    const size_t width = numQuestions + 1;
+    const double floorLikelihood = options.scoreNoise / width;
+    const double exactLikelihood = 1.0 - options.scoreNoise;
+
+    evidence.resize(numQuestions);
+    missEvidence.assign(numQuestions, 0.0);
+    for (size_t q = 0; q < numQuestions; ++q) {
+        evidence[q].assign(posterior[q].size(), 0.0);
+    }
+    prefix.resize(width * width);
+    suffix.resize((numQuestions + 1) * width);
+
+    for (size_t i = 0; i < attempts.size(); ++i) {
+        // Distribution of the number correct among the first j questions,
+        // and among questions j.. onwards, under the current beliefs
+        prefix[0] = 1.0;
+        for (size_t j = 0; j < numQuestions; ++j) {
+            const double p = posterior[j][attempts.answerId(j, i)];
+            const double* from = &prefix[j * width];
+            double* to = &prefix[(j + 1) * width];
+            to[0] = from[0] * (1.0 - p);
+            for (size_t k = 1; k <= j; ++k) {
+                to[k] = from[k] * (1.0 - p) + from[k - 1] * p;
+            }
+            to[j + 1] = from[j] * p;
+        }
+        suffix[numQuestions * width] = 1.0;
+        for (size_t j = numQuestions; j-- > 0;) {
+            const double p = posterior[j][attempts.answerId(j, i)];
+            const double* from = &suffix[(j + 1) * width];
+            double* to = &suffix[j * width];
+            const size_t count = numQuestions - j;  // questions j.. onwards
+            to[0] = from[0] * (1.0 - p);
+            for (size_t k = 1; k < count; ++k) {
+                to[k] = from[k] * (1.0 - p) + from[k - 1] * p;
+            }
+            to[count] = from[count - 1] * p;
+        }
+
+        // P(recorded count | this attempt's answer to q is or is not the
+        // key), summing over how many of the other questions it got right
+        const int observed = observedCorrect[i];
+        for (size_t q = 0; q < numQuestions; ++q) {
+            const double* before = &prefix[q * width];
+            const double* after = &suffix[(q + 1) * width];
+            const size_t afterCount = numQuestions - q - 1;
+            auto othersCorrect = [&](int count) {
+                if (count < 0) {
+                    return 0.0;
+                }
+                const size_t total = static_cast<size_t>(count);
+                double probability = 0.0;
+                const size_t first = total > afterCount ? total - afterCount : 0;
+                for (size_t j = first; j <= std::min(q, total); ++j) {
+                    probability += before[j] * after[total - j];
+                }
+                return probability;
+            };
+            const double miss = floorLikelihood + exactLikelihood * othersCorrect(observed);
+            const double match = floorLikelihood + exactLikelihood * othersCorrect(observed - 1);
+            const double logMiss = std::log(miss);
+            missEvidence[q] += logMiss;
+            evidence[q][attempts.answerId(q, i)] += std::log(match) - logMiss;
+        }
+    }
+
+    // New belief per question from the prior and the evidence, normalized
+    // in log space and mixed with the previous belief
+    double largestChange = 0.0;
+    for (size_t q = 0; q < numQuestions; ++q) {
+        std::vector<double>& belief = posterior[q];
+        const size_t answers = belief.size() - 1;
+        std::vector<double>& logBelief = evidence[q];
+        for (size_t a = 0; a < answers; ++a) {
+            logBelief[a] += missEvidence[q];
+        }
+        logBelief[answers] = options.unseenWeight > 0.0
+            ? std::log(options.unseenWeight) + missEvidence[q]
+            : -INFINITY;
+
+        const double peak = *std::max_element(logBelief.begin(), logBelief.end());
+        double total = 0.0;
+        for (double& value : logBelief) {
+            value = std::exp(value - peak);
+            total += value;
+        }
+        for (size_t a = 0; a <= answers; ++a) {
+            const double updated = options.damping * belief[a] +
+                                   (1.0 - options.damping) * logBelief[a] / total;
+            largestChange = std::max(largestChange, std::abs(updated - belief[a]));
+            belief[a] = updated;
+        }
+    }
+    return largestChange;
+}
+
+void EmScorer::score(const AttemptStore& attempts,
+                     std::vector<std::pair<std::string, double>>& result) {
+    const auto started = std::chrono::steady_clock::now();
+    const size_t numQuestions = attempts.numQuestions();
+    result.resize(attempts.empty() ? 0 : numQuestions);
+    if (attempts.empty()) {
+        reset();
+        return;
+    }
+
+    startFrom(attempts);
+    observedCorrect.resize(attempts.size());
+    for (size_t i = 0; i < attempts.size(); ++i) {
+        observedCorrect[i] = static_cast<int>(std::lround(attempts.percentage(i) * numQuestions / 100.0));
+    }
+
+    lastIterations = 0;
+    lastConverged = false;
+    while (lastIterations < options.maxIterations) {
+        const double change = sweep(attempts);
+        lastIterations++;
+        if (change <= options.tolerance) {
+            lastConverged = true;
+            break;
+        }
+        if (options.timeBudgetMs > 0.0 &&
+            std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - started).count() >= options.timeBudgetMs) {
+            break;
+        }
+    }
+    fittedAttempts = attempts.size();
+
+    // Most probable answer, ties going to the alphabetically first as in
+    // the built-in heuristic
+    for (size_t q = 0; q < numQuestions; ++q) {
+        const std::vector<double>& belief = posterior[q];
+        const std::string* bestAnswer = nullptr;
+        double bestProbability = -1.0;
+        for (const auto& [answer, id] : attempts.dictionary(q)) {
+            if (belief[id] > bestProbability) {
+                bestProbability = belief[id];
+                bestAnswer = &answer;
+            }
+        }
+        result[q].first = *bestAnswer;
+        result[q].second = 100.0 * bestProbability;
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef EM_SCORER_H
+#define EM_SCORER_H
+
+#include "answerScorer.h"
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Custom exception class for EmScorer-specific errors
+class EmScorerException : public std::runtime_error {
+public:
+    explicit EmScorerException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+struct EmScorerOptions {
+    size_t maxIterations = 200;    // convergence budget per score call
+    double timeBudgetMs = 0.0;     // stop early after this long; 0 = no limit
+    double tolerance = 1e-6;       // converged when no probability moves more than this
+    double damping = 0.5;          // share of the previous posterior kept by each step
+    double scoreNoise = 0.01;      // chance a recorded percentage is not the exact count
+    double unseenWeight = 1.0;     // prior weight of "the key is an answer nobody gave"
+};
+
+// Probabilistic scorer: estimates P(key of question q = answer a) for every
+// question from all attempts together, using that an attempt's percentage
+// is 100 * correct / Q. The posterior is factorized per question and
+// refined by an EM-style fixed-point iteration: given the current beliefs
+// about the other questions, the number of them an attempt got right
+// follows a Poisson-binomial distribution, which turns the attempt's
+// recorded count into a likelihood for "this attempt's answer to q is the
+// key" versus "it is not". Each sweep costs O(A * Q^2). Being a mean-field
+// fit it can settle on a local optimum, mostly with only a handful of
+// attempts.
+//
+// When the history has only grown since the last fit, the previous
+// posterior is the starting point, so a new attempt typically needs a few
+// sweeps rather than a full refit.
+class EmScorer : public AnswerScorer {
+private:
+    EmScorerOptions options;
+
+    // posterior[q][id] for the answers seen so far; the last entry of each
+    // question is the probability that the key is an unseen answer
+    std::vector<std::vector<double>> posterior;
+    size_t fittedAttempts;
+    size_t lastIterations;
+    bool lastConverged;
+
+    // Working buffers, kept between calls
+    std::vector<int> observedCorrect;      // [attempt]
+    std::vector<double> prefix;            // [j * (Q + 1) + k] P(k correct among questions < j)
+    std::vector<double> suffix;            // [j * (Q + 1) + k] P(k correct among questions >= j)
+    std::vector<std::vector<double>> evidence;  // [q][id] summed log-likelihood ratios
+    std::vector<double> missEvidence;      // [q] summed log-likelihoods of a miss
+
+    void startFrom(const AttemptStore& attempts);
+    double sweep(const AttemptStore& attempts);
+
+public:
+    explicit EmScorer(const EmScorerOptions& scorerOptions = EmScorerOptions());
+
+    // Core functionality
+    void score(const AttemptStore& attempts,
+               std::vector<std::pair<std::string, double>>& result) override;
+    void reset() override;
+
+    // Getters
+    // P(key = answer id) per question as of the last score call, followed
+    // by P(key is an answer nobody gave)
+    const std::vector<std::vector<double>>& getPosterior() const { return posterior; }
+    size_t getLastIterations() const { return lastIterations; }
+    bool getLastConverged() const { return lastConverged; }
+    const EmScorerOptions& getOptions() const { return options; }
+};
+
+#endif
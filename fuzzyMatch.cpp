@@ -0,0 +1,290 @@
+#include "fuzzyMatch.h"
+#include "caseFold.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Lowercase of a two-byte UTF-8 code point in the scripts we fold, else cp
+std::uint32_t foldCodePoint(std::uint32_t cp) {
+    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) {
+        return cp + 0x20;  // Latin-1 capitals, except the multiplication sign
+    }
+    if (cp >= 0x100 && cp <= 0x17F) {
+        // Latin Extended-A pairs capital and small letters, with the
+        // capital first; the pairs shift by one code point in two runs
+        if (cp == 0x130 || cp == 0x131 || cp == 0x138 || cp == 0x149 || cp == 0x17F) {
+            return cp;
+        }
+        if (cp == 0x178) {
+            return 0xFF;
+        }
+        const bool oddCapitals = (cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E);
+        return (cp % 2 == 1) == oddCapitals ? cp + 1 : cp;
+    }
+    if (cp >= 0x391 && cp <= 0x3A9 && cp != 0x3A2) {
+        return cp + 0x20;  // Greek
+    }
+    if (cp >= 0x410 && cp <= 0x42F) {
+        return cp + 0x20;  // Cyrillic
+    }
+    if (cp >= 0x400 && cp <= 0x40F) {
+        return cp + 0x50;  // Cyrillic with diacritics
+    }
+    return cp;
+}
+
+// Myers' bit-parallel edit distance in Hyyrö's formulation: one column of
+// the table per character of b, with the vertical deltas of pattern a
+// (at most 64 bytes) packed into two words
+size_t myersDistance(std::string_view a, std::string_view b, size_t maxDistance) {
+    std::uint64_t peq[256] = {};
+    for (size_t i = 0; i < a.size(); ++i) {
+        peq[static_cast<unsigned char>(a[i])] |= std::uint64_t(1) << i;
+    }
+
+    const std::uint64_t last = std::uint64_t(1) << (a.size() - 1);
+    std::uint64_t pv = ~std::uint64_t(0);
+    std::uint64_t mv = 0;
+    size_t score = a.size();
+    for (size_t j = 0; j < b.size(); ++j) {
+        const std::uint64_t eq = peq[static_cast<unsigned char>(b[j])];
+        const std::uint64_t xv = eq | mv;
+        const std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        std::uint64_t ph = mv | ~(xh | pv);
+        std::uint64_t mh = pv & xh;
+        if (ph & last) {
+            score++;
+        } else if (mh & last) {
+            score--;
+        }
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        // Each remaining column lowers the distance by at most one
+        if (score > maxDistance + (b.size() - j - 1)) {
+            return maxDistance + 1;
+        }
+    }
+    return std::min(score, maxDistance + 1);
+}
+
+// The usual table restricted to diagonals within maxDistance of the main
+// one, for patterns too long for a machine word
+size_t bandedDistance(std::string_view a, std::string_view b, size_t maxDistance) {
+    const size_t m = a.size();
+    const size_t n = b.size();
+    const size_t limit = maxDistance + 1;
+    std::vector<size_t> previous(n + 1, limit);
+    std::vector<size_t> current(n + 1, limit);
+    for (size_t j = 0; j <= std::min(n, maxDistance); ++j) {
+        previous[j] = j;
+    }
+
+    for (size_t i = 1; i <= m; ++i) {
+        const size_t low = i > maxDistance ? i - maxDistance : 0;
+        const size_t high = std::min(n, i + maxDistance);
+        size_t rowBest = limit;
+        if (low == 0) {
+            current[0] = std::min(i, limit);
+            rowBest = current[0];
+        } else {
+            current[low - 1] = limit;
+        }
+        for (size_t j = std::max<size_t>(low, 1); j <= high; ++j) {
+            const size_t substitute = previous[j - 1] + (a[i - 1] != b[j - 1]);
+            const size_t value = std::min({substitute, previous[j] + 1, current[j - 1] + 1});
+            current[j] = std::min(value, limit);
+            rowBest = std::min(rowBest, current[j]);
+        }
+        if (high < n) {
+            current[high + 1] = limit;
+        }
+        if (rowBest >= limit) {
+            return limit;
+        }
+        std::swap(previous, current);
+    }
+    return std::min(previous[n], limit);
+}
+
+}  // namespace
+
+std::string trimAnswer(std::string_view answer) {
+    std::string result;
+    result.reserve(answer.size());
+    bool pendingSpace = false;
+    for (char c : answer) {
+        if (isSpace(c)) {
+            pendingSpace = !result.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            result += ' ';
+            pendingSpace = false;
+        }
+        result += c;
+    }
+    return result;
+}
+
+std::string normalizeAnswer(std::string_view answer) {
+    std::string result = trimAnswer(answer);
+    foldCase(result);
+    for (size_t i = 0; i + 1 < result.size(); ++i) {
+        const unsigned char lead = static_cast<unsigned char>(result[i]);
+        const unsigned char next = static_cast<unsigned char>(result[i + 1]);
+        if (lead < 0xC2 || lead > 0xDF || (next & 0xC0) != 0x80) {
+            continue;
+        }
+        // Every folded code point stays below U+0800, so it is rewritten
+        // in place as two bytes again
+        const std::uint32_t cp = foldCodePoint((std::uint32_t(lead & 0x1F) << 6) | (next & 0x3F));
+        result[i] = static_cast<char>(0xC0 | (cp >> 6));
+        result[i + 1] = static_cast<char>(0x80 | (cp & 0x3F));
+        ++i;
+    }
+    return result;
+}
+
+size_t boundedLevenshtein(std::string_view a, std::string_view b, size_t maxDistance) {
+    if (a.size() > b.size()) {
+        std::swap(a, b);
+    }
+    if (b.size() - a.size() > maxDistance) {
+        return maxDistance + 1;
+    }
+    if (a.empty()) {
+        return b.size();
+    }
+    return a.size() <= 64 ? myersDistance(a, b, maxDistance) : bandedDistance(a, b, maxDistance);
+}
+
+bool answersNear(std::string_view a, std::string_view b, const FuzzyMatchOptions& options) {
+    const std::string first = normalizeAnswer(a);
+    const std::string second = normalizeAnswer(b);
+    if (first == second) {
+        return true;
+    }
+    const size_t edits = allowedEdits(options, std::min(first.size(), second.size()));
+    return edits > 0 && boundedLevenshtein(first, second, edits) <= edits;
+}
+
+void FuzzyAnswerIndex::distinctBigrams(const std::string& text) {
+    queryBigrams.clear();
+    for (size_t i = 0; i + 1 < text.size(); ++i) {
+        queryBigrams.push_back(static_cast<std::uint16_t>(
+            (static_cast<unsigned char>(text[i]) << 8) | static_cast<unsigned char>(text[i + 1])));
+    }
+    std::sort(queryBigrams.begin(), queryBigrams.end());
+    queryBigrams.erase(std::unique(queryBigrams.begin(), queryBigrams.end()), queryBigrams.end());
+}
+
+std::uint32_t FuzzyAnswerIndex::addCluster(std::string_view answer, std::string&& key) {
+    const std::uint32_t cluster = static_cast<std::uint32_t>(representatives.size());
+    representatives.push_back(trimAnswer(answer));
+    normalized.push_back(std::move(key));
+    exact.emplace(normalized.back(), cluster);
+    shared.push_back(0);
+    distinctBigrams(normalized.back());
+    for (std::uint16_t bigram : queryBigrams) {
+        bigrams[bigram].push_back(cluster);
+    }
+    return cluster;
+}
+
+const std::string& FuzzyAnswerIndex::canonical(std::string_view answer) {
+    std::string key = normalizeAnswer(answer);
+    auto found = exact.find(key);
+    if (found != exact.end()) {
+        return representatives[found->second];
+    }
+
+    const size_t edits = allowedEdits(options, key.size());
+    if (edits == 0) {
+        return representatives[addCluster(answer, std::move(key))];
+    }
+
+    // Clusters sharing enough bigrams, or all of them when the answer is
+    // too short for the bigram bound to exclude anything
+    distinctBigrams(key);
+    const size_t needed = queryBigrams.size() > 2 * edits ? queryBigrams.size() - 2 * edits : 0;
+    touched.clear();
+    if (needed == 0) {
+        for (std::uint32_t cluster = 0; cluster < representatives.size(); ++cluster) {
+            touched.push_back(cluster);
+        }
+    } else {
+        for (std::uint16_t bigram : queryBigrams) {
+            auto clusters = bigrams.find(bigram);
+            if (clusters == bigrams.end()) {
+                continue;
+            }
+            for (std::uint32_t cluster : clusters->second) {
+                if (shared[cluster]++ == 0) {
+                    touched.push_back(cluster);
+                }
+            }
+        }
+    }
+
+    std::uint32_t best = UINT32_MAX;
+    size_t bestDistance = edits + 1;
+    for (std::uint32_t cluster : touched) {
+        const std::string& candidate = normalized[cluster];
+        const bool eligible = shared[cluster] >= needed && candidate.size() >= options.minLength;
+        shared[cluster] = 0;
+        if (!eligible) {
+            continue;
+        }
+        const size_t distance = boundedLevenshtein(key, candidate, edits);
+        if (distance < bestDistance || (distance == bestDistance && cluster < best)) {
+            best = cluster;
+            bestDistance = distance;
+        }
+    }
+
+    if (best == UINT32_MAX) {
+        return representatives[addCluster(answer, std::move(key))];
+    }
+    // Remember the spelling so it is found directly next time
+    exact.emplace(std::move(key), best);
+    return representatives[best];
+}
+
+// Spellings remembered for the clusters that stay are left; they would
+// find the same cluster again
+void FuzzyAnswerIndex::truncate(size_t clusters) {
+    if (clusters >= representatives.size()) {
+        return;
+    }
+    representatives.resize(clusters);
+    normalized.resize(clusters);
+    shared.resize(clusters);
+    for (auto entry = exact.begin(); entry != exact.end();) {
+        entry = entry->second >= clusters ? exact.erase(entry) : std::next(entry);
+    }
+    // Clusters are appended to the bigram lists in order
+    for (auto entry = bigrams.begin(); entry != bigrams.end();) {
+        std::vector<std::uint32_t>& list = entry->second;
+        while (!list.empty() && list.back() >= clusters) {
+            list.pop_back();
+        }
+        entry = list.empty() ? bigrams.erase(entry) : std::next(entry);
+    }
+}
+
+void FuzzyAnswerIndex::clear() {
+    representatives.clear();
+    normalized.clear();
+    exact.clear();
+    bigrams.clear();
+    shared.clear();
+    touched.clear();
+}
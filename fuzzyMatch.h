@@ -0,0 +1,79 @@
+#ifndef FUZZY_MATCH_H
+#define FUZZY_MATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct FuzzyMatchOptions {
+    size_t maxEdits = 1;    // Levenshtein distance still counted as the same answer
+    size_t minLength = 4;   // shorter normalized answers must match exactly
+};
+
+// Collapse runs of whitespace to one space and drop it at both ends
+std::string trimAnswer(std::string_view answer);
+
+// trimAnswer followed by case folding: ASCII, Latin-1, Latin Extended-A,
+// Greek and Cyrillic capitals become lowercase. Other text is kept as is.
+std::string normalizeAnswer(std::string_view answer);
+
+// Levenshtein distance between a and b in bytes, or maxDistance + 1 if it
+// is larger. Uses Myers' bit-parallel algorithm when the shorter string
+// fits in 64 bytes and a diagonal band of the usual table otherwise.
+size_t boundedLevenshtein(std::string_view a, std::string_view b, size_t maxDistance);
+
+// Edits allowed between two normalized answers, the shorter being length
+// bytes long
+inline size_t allowedEdits(const FuzzyMatchOptions& options, size_t length) {
+    return length < options.minLength ? 0 : options.maxEdits;
+}
+
+// Whether two answers are the same once normalized or within the allowed
+// edits of each other
+bool answersNear(std::string_view a, std::string_view b, const FuzzyMatchOptions& options);
+
+// Near-duplicate clustering of one question's answers. Each cluster is
+// represented by the first spelling that opened it, trimmed; an answer
+// joins the closest cluster whose normalized representative is within the
+// allowed edits, ties going to the oldest, and otherwise opens a new one.
+// Comparing against representatives only keeps clusters from drifting
+// through chains of small edits.
+//
+// Candidates are found through an index of the representatives' byte
+// bigrams: an edit destroys at most two bigrams, so a representative
+// within k edits shares all but 2k of the answer's distinct bigrams. Only
+// those candidates reach the edit distance check.
+class FuzzyAnswerIndex {
+private:
+    FuzzyMatchOptions options;
+    std::vector<std::string> representatives;  // [cluster]
+    std::vector<std::string> normalized;       // [cluster]
+    std::unordered_map<std::string, std::uint32_t> exact;  // normalized answer -> cluster
+    std::unordered_map<std::uint16_t, std::vector<std::uint32_t>> bigrams;  // -> clusters
+    std::vector<std::uint32_t> shared;   // [cluster] bigrams in common, scratch
+    std::vector<std::uint32_t> touched;  // clusters with shared != 0, scratch
+    std::vector<std::uint16_t> queryBigrams;
+
+    void distinctBigrams(const std::string& text);
+    std::uint32_t addCluster(std::string_view answer, std::string&& key);
+
+public:
+    explicit FuzzyAnswerIndex(const FuzzyMatchOptions& matchOptions = FuzzyMatchOptions())
+        : options(matchOptions) {}
+
+    // Core functionality
+    // Representative of the cluster answer belongs to, opening one if
+    // needed; valid until the next call
+    const std::string& canonical(std::string_view answer);
+    void truncate(size_t clusters);  // drop every cluster opened after the first ones
+    void clear();
+
+    // Getters
+    size_t size() const { return representatives.size(); }
+    const FuzzyMatchOptions& getOptions() const { return options; }
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "lzBlock.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+const size_t kMinMatch = 4;
+const size_t kLastLiterals = 5;   // the format ends every block with literals
+const size_t kMatchLimit = 12;    // no match starts in the last 12 bytes
+const size_t kMaxOffset = 65535;
+const int kHashBits = 12;
+const std::uint32_t kNoPosition = UINT32_MAX;
+
+inline std::uint32_t read32(const char* p) {
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline std::uint32_t hashSequence(std::uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+// Lengths of 15 and more continue in bytes of 255 and a final remainder
+void writeLength(std::string& out, size_t length) {
+    for (length -= 15; length >= 255; length -= 255) {
+        out += static_cast<char>(255);
+    }
+    out += static_cast<char>(length);
+}
+
+bool readLength(const unsigned char* data, size_t size, size_t& in, size_t& length) {
+    unsigned char byte;
+    do {
+        if (in >= size) {
+            return false;
+        }
+        byte = data[in++];
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// One sequence; the last one of a block has literals only
+void writeSequence(std::string& out, const char* literals, size_t literalCount,
+                   size_t matchLength, size_t offset) {
+    const size_t matchCode = matchLength > 0 ? matchLength - kMinMatch : 0;
+    out += static_cast<char>((std::min<size_t>(literalCount, 15) << 4) |
+                             std::min<size_t>(matchCode, 15));
+    if (literalCount >= 15) {
+        writeLength(out, literalCount);
+    }
+    out.append(literals, literalCount);
+    if (matchLength == 0) {
+        return;
+    }
+    out += static_cast<char>(offset & 0xFF);
+    out += static_cast<char>(offset >> 8);
+    if (matchCode >= 15) {
+        writeLength(out, matchCode);
+    }
+}
+
+}  // namespace
+
+void lzCompressBlock(const char* data, size_t size, std::string& out) {
+    size_t anchor = 0;
+    if (size > kMatchLimit) {
+        std::array<std::uint32_t, size_t(1) << kHashBits> table;
+        table.fill(kNoPosition);
+        const size_t matchStartEnd = size - kMatchLimit;
+        const size_t matchEnd = size - kLastLiterals;
+
+        size_t pos = 0;
+        while (pos < matchStartEnd) {
+            const std::uint32_t sequence = read32(data + pos);
+            std::uint32_t& slot = table[hashSequence(sequence)];
+            const std::uint32_t candidate = slot;
+            slot = static_cast<std::uint32_t>(pos);
+            if (candidate == kNoPosition || pos - candidate > kMaxOffset ||
+                read32(data + candidate) != sequence) {
+                pos++;
+                continue;
+            }
+
+            size_t length = kMinMatch;
+            while (pos + length < matchEnd && data[candidate + length] == data[pos + length]) {
+                length++;
+            }
+            writeSequence(out, data + anchor, pos - anchor, length, pos - candidate);
+            pos += length;
+            anchor = pos;
+        }
+    }
+    writeSequence(out, data + anchor, size - anchor, 0, 0);
+}
+
+bool lzDecompressBlock(const char* data, size_t size, char* out, size_t outSize) {
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+    size_t inPos = 0;
+    size_t outPos = 0;
+    while (true) {
+        if (inPos >= size) {
+            return false;
+        }
+        const unsigned char token = in[inPos++];
+
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !readLength(in, size, inPos, literalCount)) {
+            return false;
+        }
+        if (size - inPos < literalCount || outSize - outPos < literalCount) {
+            return false;
+        }
+        std::memcpy(out + outPos, data + inPos, literalCount);
+        inPos += literalCount;
+        outPos += literalCount;
+        if (inPos == size) {
+            return outPos == outSize;
+        }
+
+        if (size - inPos < 2) {
+            return false;
+        }
+        const size_t offset = in[inPos] | (size_t(in[inPos + 1]) << 8);
+        inPos += 2;
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(in, size, inPos, matchLength)) {
+            return false;
+        }
+        matchLength += kMinMatch;
+        if (offset == 0 || offset > outPos || outSize - outPos < matchLength) {
+            return false;
+        }
+
+        // A match may overlap its own output, repeating the last offset bytes
+        char* target = out + outPos;
+        const char* source = target - offset;
+        if (offset >= matchLength) {
+            std::memcpy(target, source, matchLength);
+        } else {
+            for (size_t i = 0; i < matchLength; ++i) {
+                target[i] = source[i];
+            }
+        }
+        outPos += matchLength;
+    }
+}
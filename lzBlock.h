@@ -0,0 +1,19 @@
+#ifndef LZ_BLOCK_H
+#define LZ_BLOCK_H
+
+#include <cstddef>
+#include <string>
+
+// LZ77 compression of independent blocks in the LZ4 block format: runs of
+// literals, each followed by a back-reference of at least four bytes into
+// the previous 64 KiB of output. Matching is greedy over a small hash
+// table, so compression is fast and decompression is mostly memcpy.
+//
+// Append the compressed form of size bytes at data to out
+void lzCompressBlock(const char* data, size_t size, std::string& out);
+
+// Decompress a block into exactly outSize bytes at out. Returns false if
+// the block is malformed or decodes to any other size.
+bool lzDecompressBlock(const char* data, size_t size, char* out, size_t outSize);
+
+#endif
@@ -1,5 +1,6 @@
 #include "answerTracker.h"
 #include "answerAnalyzer.h"
+#include "batchCli.h"
 #include <iostream>
 #include <limits>
 #include <iomanip>
@@ -46,8 +47,9 @@ void displayFileMenu() {
     std::cout << "\n=== File Operations ===" << std::endl;
     std::cout << "1. Save Analysis Data" << std::endl;
     std::cout << "2. Load Analysis Data" << std::endl;
-    std::cout << "3. Return to Main Menu" << std::endl;
-    std::cout << "\nEnter your choice (1-3): ";
+    std::cout << "3. Keep a Journal (saves each attempt as it is entered)" << std::endl;
+    std::cout << "4. Return to Main Menu" << std::endl;
+    std::cout << "\nEnter your choice (1-4): ";
 }
 
 void displayHelp() {
@@ -135,6 +137,27 @@ void enterNewAttempt(AnswerAnalyzer& analyzer) {
     }
 }
 
+void displayDefiniteAnswers(const AnswerAnalyzer& analyzer) {
+    analyzer.analyzeResults();
+    
+    const auto& definite = analyzer.getDefiniteAnswers();
+    std::cout << "\n=== Definite Answers (latest attempt) ===" << std::endl;
+    for (size_t i = 0; i < analyzer.getFirstAttemptSize() && i < definite.size(); ++i) {
+        std::cout << "Question " << (i + 1) << ": ";
+        if (!definite[i].has_value()) {
+            std::cout << "unknown" << std::endl;
+        } else {
+            setTextColor(*definite[i] ? 2 : 4); // Green or red
+            std::cout << (*definite[i] ? "correct" : "incorrect") << std::endl;
+            setTextColor(7); // Reset color
+        }
+    }
+    
+    if (auto count = analyzer.getModelCount()) {
+        std::cout << "Consistent answer keys: " << *count << std::endl;
+    }
+}
+
 void viewStatistics(const AnswerAnalyzer& analyzer) {
     int choice;
     do {
@@ -219,7 +242,11 @@ void handleFileOperations(AnswerAnalyzer& analyzer) {
             case 1: {
                 std::cout << "Enter filename to save: ";
                 std::getline(std::cin, filename);
-                analyzer.saveToFile(filename);
+                std::cout << "Save as binary? Faster to load, not human readable (y/n): ";
+                std::string format;
+                std::getline(std::cin, format);
+                analyzer.saveToFile(filename, format == "y" || format == "Y" ? FileFormat::Binary
+                                                                             : FileFormat::Text);
                 std::cout << "Data saved successfully!" << std::endl;
                 break;
             }
@@ -232,7 +259,16 @@ void handleFileOperations(AnswerAnalyzer& analyzer) {
                 break;
             }
                 
-            case 3:
+            case 3: {
+                std::cout << "Enter filename for the journal: ";
+                std::getline(std::cin, filename);
+                analyzer.openJournal(filename);
+                std::cout << "Journal open with " << analyzer.getNumAttempts()
+                          << " attempts. New attempts are saved as they are entered." << std::endl;
+                break;
+            }
+                
+            case 4:
                 return;
                 
             default:
@@ -242,7 +278,13 @@ void handleFileOperations(AnswerAnalyzer& analyzer) {
     } while (true);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Any arguments select the non-interactive batch mode
+    if (argc > 1) {
+        std::ios::sync_with_stdio(false);
+        return runBatch(std::vector<std::string>(argv + 1, argv + argc), std::cout, std::cerr);
+    }
+    
     AnswerAnalyzer analyzer;
     int choice;
     
@@ -261,7 +303,7 @@ int main() {
                     break;
                     
                 case 2:
-                    analyzer.analyzeResults();
+                    displayDefiniteAnswers(analyzer);
                     break;
                     
                 case 3:
@@ -294,7 +336,9 @@ int main() {
                 }
                     
                 case 7: {
-                    if (analyzer.getNumAttempts() > 0) {
+                    if (analyzer.hasJournal()) {
+                        analyzer.closeJournal();
+                    } else if (analyzer.getNumAttempts() > 0) {
                         char confirm;
                         std::cout << "You have unsaved data. Are you sure you want to exit? (y/n): ";
                         std::cin >> confirm;
@@ -0,0 +1,66 @@
+#include "mappedFile.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPED_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+#ifdef MAPPED_FILE_MMAP
+
+MappedFile::MappedFile(const std::string& filename) : bytes(nullptr), length(0) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw MappedFileException("Cannot open file for reading: " + filename);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw MappedFileException("Cannot read file size: " + filename);
+    }
+    length = static_cast<size_t>(info.st_size);
+
+    // mmap rejects empty mappings; an empty file simply has no data
+    if (length > 0) {
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throw MappedFileException("Cannot map file: " + filename);
+        }
+        bytes = static_cast<const char*>(mapped);
+    }
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (bytes) {
+        ::munmap(const_cast<char*>(bytes), length);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename) : bytes(nullptr), length(0) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) {
+        throw MappedFileException("Cannot open file for reading: " + filename);
+    }
+
+    length = static_cast<size_t>(file.tellg());
+    buffer.resize((length + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(length))) {
+        throw MappedFileException("Error reading from file: " + filename);
+    }
+    bytes = reinterpret_cast<const char*>(buffer.data());
+}
+
+MappedFile::~MappedFile() {}
+
+#endif
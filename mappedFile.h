@@ -0,0 +1,38 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Custom exception class for MappedFile-specific errors
+class MappedFileException : public std::runtime_error {
+public:
+    explicit MappedFileException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+// Read-only view of a whole file. On POSIX systems the file is mapped with
+// mmap, so its pages are only read when touched; elsewhere it is read into
+// an 8-byte aligned buffer. Either way data() stays valid for the lifetime
+// of the object.
+class MappedFile {
+private:
+    const char* bytes;
+    size_t length;
+    std::vector<std::uint64_t> buffer;  // fallback storage when mmap is unavailable
+
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
+
+#endif
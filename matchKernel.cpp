@@ -0,0 +1,114 @@
+#include "matchKernel.h"
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define MATCH_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef void (*MatchKernel)(const std::uint16_t*, size_t, std::uint16_t, double, double*);
+
+void accumulateScalar(const std::uint16_t* column, size_t count, std::uint16_t id,
+                      double weight, double* scores) {
+    for (size_t i = 0; i < count; ++i) {
+        if (column[i] == id) {
+            scores[i] += weight;
+        }
+    }
+}
+
+#ifdef MATCH_KERNEL_X86
+
+// Four attempts per step: widen the ids to 64-bit lanes so the equality
+// mask lines up with the doubles it selects
+__attribute__((target("avx2")))
+void accumulateAvx2(const std::uint16_t* column, size_t count, std::uint16_t id,
+                    double weight, double* scores) {
+    const __m256i wanted = _mm256_set1_epi64x(id);
+    const __m256d weights = _mm256_set1_pd(weight);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        // Skip blocks of sixteen with no match at all, the common case
+        __m256i ids = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i));
+        __m256i equal = _mm256_cmpeq_epi16(ids, _mm256_set1_epi16(static_cast<short>(id)));
+        if (_mm256_testz_si256(equal, equal)) {
+            continue;
+        }
+        for (size_t j = i; j < i + 16; j += 4) {
+            __m128i four = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(column + j));
+            __m256d mask = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_cvtepu16_epi64(four), wanted));
+            __m256d sums = _mm256_loadu_pd(scores + j);
+            _mm256_storeu_pd(scores + j, _mm256_add_pd(sums, _mm256_and_pd(mask, weights)));
+        }
+    }
+    accumulateScalar(column + i, count - i, id, weight, scores + i);
+}
+
+__attribute__((target("sse4.1")))
+void accumulateSse41(const std::uint16_t* column, size_t count, std::uint16_t id,
+                     double weight, double* scores) {
+    const __m128i wanted = _mm_set1_epi64x(id);
+    const __m128d weights = _mm_set1_pd(weight);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i ids = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i));
+        __m128i equal = _mm_cmpeq_epi16(ids, _mm_set1_epi16(static_cast<short>(id)));
+        if (_mm_testz_si128(equal, equal)) {
+            continue;
+        }
+        for (size_t j = i; j < i + 8; j += 2) {
+            int pair;
+            std::memcpy(&pair, column + j, sizeof(pair));
+            __m128i two = _mm_cvtsi32_si128(pair);
+            __m128d mask = _mm_castsi128_pd(_mm_cmpeq_epi64(_mm_cvtepu16_epi64(two), wanted));
+            __m128d sums = _mm_loadu_pd(scores + j);
+            _mm_storeu_pd(scores + j, _mm_add_pd(sums, _mm_and_pd(mask, weights)));
+        }
+    }
+    accumulateScalar(column + i, count - i, id, weight, scores + i);
+}
+
+#endif
+
+struct KernelChoice {
+    MatchKernel kernel;
+    const char* name;
+};
+
+KernelChoice detectKernel() {
+#ifdef MATCH_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {accumulateAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return {accumulateSse41, "sse4.1"};
+    }
+#endif
+    return {accumulateScalar, "scalar"};
+}
+
+bool forceScalar = false;
+
+const KernelChoice& selectedKernel() {
+    static const KernelChoice detected = detectKernel();
+    static const KernelChoice scalar = {accumulateScalar, "scalar"};
+    return forceScalar ? scalar : detected;
+}
+
+}  // namespace
+
+void accumulateMatchWeights(const std::uint16_t* column, size_t count, std::uint16_t id,
+                            double weight, double* scores) {
+    selectedKernel().kernel(column, count, id, weight, scores);
+}
+
+const char* matchKernelName() {
+    return selectedKernel().name;
+}
+
+void useScalarMatchKernel(bool scalar) {
+    forceScalar = scalar;
+}
@@ -0,0 +1,20 @@
+#ifndef MATCH_KERNEL_H
+#define MATCH_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Adds weight to scores[i] for every i < count with column[i] == id.
+// The widest implementation the CPU supports (AVX2, SSE4.1 or plain C++)
+// is picked on first use. Each score gets the same sequence of additions in
+// every implementation, so results are bit-identical across them.
+void accumulateMatchWeights(const std::uint16_t* column, size_t count, std::uint16_t id,
+                            double weight, double* scores);
+
+// Name of the implementation accumulateMatchWeights dispatches to
+const char* matchKernelName();
+
+// Force the portable implementation, e.g. to compare against it
+void useScalarMatchKernel(bool scalar);
+
+#endif
@@ -0,0 +1,180 @@
+#include "scoreIndex.h"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+
+// Heap priority of a node: a fixed mix of its number (lowbias32)
+std::uint32_t priority(std::uint32_t node) {
+    std::uint32_t x = node + 0x9e3779b9u;
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+}  // namespace
+
+// Rank order: higher score first, then lower attempt number
+bool ScoreIndex::before(std::uint32_t a, std::uint32_t b) const {
+    return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+}
+
+std::uint32_t ScoreIndex::subtreeSize(std::uint32_t node) const {
+    return node == kNone ? 0 : nodes[node].size;
+}
+
+void ScoreIndex::update(std::uint32_t node) {
+    nodes[node].size = 1 + subtreeSize(nodes[node].left) + subtreeSize(nodes[node].right);
+}
+
+// Split tree into the nodes ranked before key and the rest
+void ScoreIndex::split(std::uint32_t tree, std::uint32_t key,
+                       std::uint32_t& low, std::uint32_t& high) {
+    if (tree == kNone) {
+        low = high = kNone;
+        return;
+    }
+    if (before(tree, key)) {
+        split(nodes[tree].right, key, nodes[tree].right, high);
+        low = tree;
+    } else {
+        split(nodes[tree].left, key, low, nodes[tree].left);
+        high = tree;
+    }
+    update(tree);
+}
+
+std::uint32_t ScoreIndex::insertNode(std::uint32_t tree, std::uint32_t node) {
+    if (tree == kNone) {
+        return node;
+    }
+    if (priority(node) > priority(tree)) {
+        split(tree, node, nodes[node].left, nodes[node].right);
+        update(node);
+        return node;
+    }
+    if (before(node, tree)) {
+        nodes[tree].left = insertNode(nodes[tree].left, node);
+    } else {
+        nodes[tree].right = insertNode(nodes[tree].right, node);
+    }
+    update(tree);
+    return tree;
+}
+
+void ScoreIndex::insert(size_t attempt, double percentage) {
+    if (attempt != nodes.size()) {
+        throw ScoreIndexException("Attempts must be added to the score index in order");
+    }
+    if (attempt >= kNone) {
+        throw ScoreIndexException("Too many attempts for the score index");
+    }
+    scores.push_back(percentage);
+    nodes.emplace_back();
+    root = insertNode(root, static_cast<std::uint32_t>(attempt));
+}
+
+// Sort once, then build the treap in linear time along the sorted order:
+// each node becomes the right child of the last node on the stack with a
+// higher priority, adopting the lower-priority nodes it pops as its left
+// subtree. A node's subtree is complete when it is popped.
+void ScoreIndex::assign(const double* percentages, size_t count) {
+    if (count >= kNone) {
+        throw ScoreIndexException("Too many attempts for the score index");
+    }
+    scores.assign(percentages, percentages + count);
+    nodes.assign(count, Node());
+
+    std::vector<std::uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+        return scores[a] > scores[b];
+    });
+
+    std::vector<std::uint32_t>& stack = path;
+    stack.clear();
+    for (std::uint32_t node : order) {
+        std::uint32_t last = kNone;
+        while (!stack.empty() && priority(stack.back()) < priority(node)) {
+            last = stack.back();
+            stack.pop_back();
+            update(last);
+        }
+        nodes[node].left = last;
+        if (!stack.empty()) {
+            nodes[stack.back()].right = node;
+        }
+        stack.push_back(node);
+    }
+    while (!stack.empty()) {
+        update(stack.back());
+        root = stack.back();
+        stack.pop_back();
+    }
+    if (count == 0) {
+        root = kNone;
+    }
+}
+
+void ScoreIndex::clear() {
+    scores.clear();
+    nodes.clear();
+    root = kNone;
+}
+
+size_t ScoreIndex::select(size_t rank) const {
+    if (rank >= nodes.size()) {
+        throw ScoreIndexException("Score rank out of range");
+    }
+    std::uint32_t node = root;
+    for (;;) {
+        size_t leftSize = subtreeSize(nodes[node].left);
+        if (rank < leftSize) {
+            node = nodes[node].left;
+        } else if (rank == leftSize) {
+            return node;
+        } else {
+            rank -= leftSize + 1;
+            node = nodes[node].right;
+        }
+    }
+}
+
+size_t ScoreIndex::countAbove(double percentage) const {
+    size_t count = 0;
+    std::uint32_t node = root;
+    while (node != kNone) {
+        if (scores[node] > percentage) {
+            count += subtreeSize(nodes[node].left) + 1;
+            node = nodes[node].right;
+        } else {
+            node = nodes[node].left;
+        }
+    }
+    return count;
+}
+
+void ScoreIndex::topK(size_t k, std::vector<size_t>& out) const {
+    k = std::min(k, nodes.size());
+    out.resize(k);
+    path.clear();
+    std::uint32_t node = root;
+    for (size_t filled = 0; filled < k;) {
+        while (node != kNone) {
+            path.push_back(node);
+            node = nodes[node].left;
+        }
+        node = path.back();
+        path.pop_back();
+        out[filled++] = node;
+        node = nodes[node].right;
+    }
+}
+
+size_t ScoreIndex::memoryUsage() const {
+    return scores.capacity() * sizeof(double) + nodes.capacity() * sizeof(Node) +
+           path.capacity() * sizeof(std::uint32_t);
+}
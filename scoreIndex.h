@@ -0,0 +1,65 @@
+#ifndef SCORE_INDEX_H
+#define SCORE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Custom exception class for ScoreIndex-specific errors
+class ScoreIndexException : public std::runtime_error {
+public:
+    explicit ScoreIndexException(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+// Attempts ordered by descending percentage, ties in insertion order, kept
+// in an order-statistic treap so that adding an attempt, finding the
+// attempt at a rank and counting the attempts above a score all take
+// O(log A) expected time. Attempts are numbered densely as in the
+// AttemptStore, which lets node i simply be attempt i; a node's heap
+// priority is a hash of its number, so the shape depends only on the
+// scores and no random state is kept.
+class ScoreIndex {
+private:
+    static const std::uint32_t kNone = UINT32_MAX;
+
+    struct Node {
+        std::uint32_t left = kNone;
+        std::uint32_t right = kNone;
+        std::uint32_t size = 1;  // nodes in this subtree
+    };
+
+    std::vector<double> scores;  // [attempt]
+    std::vector<Node> nodes;     // [attempt]
+    std::uint32_t root = kNone;
+    mutable std::vector<std::uint32_t> path;  // traversal stack, kept to avoid allocating
+
+    bool before(std::uint32_t a, std::uint32_t b) const;
+    std::uint32_t subtreeSize(std::uint32_t node) const;
+    void update(std::uint32_t node);
+    void split(std::uint32_t tree, std::uint32_t key, std::uint32_t& low, std::uint32_t& high);
+    std::uint32_t insertNode(std::uint32_t tree, std::uint32_t node);
+
+public:
+    // Core functionality
+    // attempt must be the next number, i.e. size()
+    void insert(size_t attempt, double percentage);
+    // Replace the contents with attempts 0..count-1
+    void assign(const double* percentages, size_t count);
+    void clear();
+
+    // Queries
+    size_t select(size_t rank) const;            // attempt at rank 0 = best score
+    size_t countAbove(double percentage) const;  // attempts scoring strictly higher
+    // The first k attempts in rank order into out, replacing its contents
+    void topK(size_t k, std::vector<size_t>& out) const;
+
+    // Getters
+    size_t size() const { return nodes.size(); }
+    bool empty() const { return nodes.empty(); }
+    size_t memoryUsage() const;
+};
+
+#endif
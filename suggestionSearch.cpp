@@ -0,0 +1,172 @@
+#include "suggestionSearch.h"
+#include <chrono>
+#include <cmath>
+#include <random>
+
+namespace {
+
+// Bits of entropy one expected correct answer is worth when breaking ties
+const double kScoreTieBreak = 1e-3;
+
+// c * log2(c), with 0 for c == 0
+double plogp(size_t count) {
+    return count == 0 ? 0.0 : count * std::log2(static_cast<double>(count));
+}
+
+}  // namespace
+
+SuggestionSearch::SuggestionSearch(std::vector<std::vector<std::uint16_t>> sampledKeys,
+                                   std::vector<std::vector<std::uint16_t>> questionChoices)
+    : keys(std::move(sampledKeys)), choices(std::move(questionChoices)) {}
+
+double SuggestionSearch::objectiveValue(const std::vector<size_t>& histogram, size_t totalMatches,
+                                        SuggestionObjective objective) const {
+    if (keys.empty()) {
+        return 0.0;
+    }
+    double numKeys = static_cast<double>(keys.size());
+    if (objective == SuggestionObjective::ExpectedScore) {
+        return totalMatches / numKeys;
+    }
+
+    // Every key is equally likely, so the entropy of the returned score is
+    // log2(K) - sum(c log2 c) / K over the histogram of scores. Among equally
+    // informative sheets prefer the higher expected score, so once the keys
+    // agree the search settles on submitting the key itself.
+    double sum = 0.0;
+    for (size_t count : histogram) {
+        sum += plogp(count);
+    }
+    double expectedScore = totalMatches / numKeys;
+    return std::log2(numKeys) - sum / numKeys + kScoreTieBreak * expectedScore;
+}
+
+double SuggestionSearch::evaluate(const std::vector<std::uint16_t>& sheet,
+                                  SuggestionObjective objective) const {
+    std::vector<size_t> histogram(choices.size() + 1, 0);
+    size_t totalMatches = 0;
+    for (const auto& key : keys) {
+        size_t matches = 0;
+        for (size_t q = 0; q < choices.size(); ++q) {
+            if (key[q] == sheet[q]) {
+                matches++;
+            }
+        }
+        histogram[matches]++;
+        totalMatches += matches;
+    }
+    return objectiveValue(histogram, totalMatches, objective);
+}
+
+std::vector<std::uint16_t> SuggestionSearch::search(std::vector<std::uint16_t> start,
+                                                    const SuggestionOptions& options) const {
+    const size_t numQuestions = choices.size();
+    if (keys.empty() || numQuestions == 0) {
+        return start;
+    }
+
+    // Current sheet, the score it gets under each key and the histogram of
+    // those scores; a move changes one question and updates all three in O(K)
+    std::vector<std::uint16_t> sheet = std::move(start);
+    std::vector<size_t> matches(keys.size(), 0);
+    std::vector<size_t> histogram(numQuestions + 1, 0);
+    size_t totalMatches = 0;
+    for (size_t k = 0; k < keys.size(); ++k) {
+        for (size_t q = 0; q < numQuestions; ++q) {
+            if (keys[k][q] == sheet[q]) {
+                matches[k]++;
+            }
+        }
+        histogram[matches[k]]++;
+        totalMatches += matches[k];
+    }
+
+    std::vector<size_t> movable;
+    for (size_t q = 0; q < numQuestions; ++q) {
+        if (choices[q].size() > 1) {
+            movable.push_back(q);
+        }
+    }
+
+    double current = objectiveValue(histogram, totalMatches, options.objective);
+    double best = current;
+    std::vector<std::uint16_t> bestSheet = sheet;
+    if (movable.empty()) {
+        return bestSheet;
+    }
+
+    // Geometric cooling from a tenth of a bit (or answer) down to almost
+    // greedy over the iteration budget
+    std::mt19937 random(options.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const double startTemperature = 0.1;
+    const double endTemperature = 1e-4;
+    const double cooling = std::pow(endTemperature / startTemperature,
+                                    1.0 / std::max<size_t>(options.maxIterations, 1));
+    double temperature = startTemperature;
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<size_t> changed;
+    for (size_t iteration = 0; iteration < options.maxIterations; ++iteration, temperature *= cooling) {
+        if (options.timeBudgetMs > 0.0 && (iteration & 255) == 0) {
+            double elapsed = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - startTime).count();
+            if (elapsed > options.timeBudgetMs) {
+                break;
+            }
+        }
+
+        size_t q = movable[random() % movable.size()];
+        std::uint16_t oldOption = sheet[q];
+        std::uint16_t newOption = choices[q][random() % choices[q].size()];
+        if (newOption == oldOption) {
+            continue;
+        }
+
+        // Apply the move, remembering which keys changed score
+        changed.clear();
+        for (size_t k = 0; k < keys.size(); ++k) {
+            std::uint16_t answer = keys[k][q];
+            if (answer == oldOption || answer == newOption) {
+                histogram[matches[k]]--;
+                if (answer == oldOption) {
+                    matches[k]--;
+                    totalMatches--;
+                } else {
+                    matches[k]++;
+                    totalMatches++;
+                }
+                histogram[matches[k]]++;
+                changed.push_back(k);
+            }
+        }
+        sheet[q] = newOption;
+
+        double candidate = objectiveValue(histogram, totalMatches, options.objective);
+        double delta = candidate - current;
+        if (delta >= 0.0 || unit(random) < std::exp(delta / temperature)) {
+            current = candidate;
+            if (current > best) {
+                best = current;
+                bestSheet = sheet;
+            }
+            continue;
+        }
+
+        // Rejected: undo
+        for (size_t k : changed) {
+            histogram[matches[k]]--;
+            if (keys[k][q] == oldOption) {
+                matches[k]++;
+                totalMatches++;
+            } else {
+                matches[k]--;
+                totalMatches--;
+            }
+            histogram[matches[k]]++;
+        }
+        sheet[q] = oldOption;
+    }
+
+    return bestSheet;
+}
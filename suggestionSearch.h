@@ -0,0 +1,49 @@
+#ifndef SUGGESTION_SEARCH_H
+#define SUGGESTION_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// What the next answer sheet should be chosen for
+enum class SuggestionObjective {
+    InformationGain,  // maximize the entropy of the score it will get back, then the score
+    ExpectedScore     // maximize the expected number of correct answers
+};
+
+struct SuggestionOptions {
+    SuggestionObjective objective = SuggestionObjective::InformationGain;
+    size_t maxIterations = 20000;  // annealing moves
+    double timeBudgetMs = 0.0;     // stop early after this long; 0 = no limit
+    size_t sampleKeys = 256;       // answer keys drawn to represent the uncertainty
+    std::uint32_t seed = 1;        // searches with equal seeds and no time limit are reproducible
+};
+
+// Simulated annealing over answer sheets. The hidden key is represented by a
+// sample of plausible keys; the score a sheet would get under each of them
+// gives both objectives. A sheet holds one option id per question, taken
+// from that question's list of choices.
+class SuggestionSearch {
+private:
+    std::vector<std::vector<std::uint16_t>> keys;  // [key][question]
+    std::vector<std::vector<std::uint16_t>> choices;  // options a sheet may use, per question
+
+    double objectiveValue(const std::vector<size_t>& histogram, size_t totalMatches,
+                          SuggestionObjective objective) const;
+
+public:
+    // keys[k][q] may be an id missing from choices[q], for an answer the
+    // sheet cannot name; such a question never matches
+    SuggestionSearch(std::vector<std::vector<std::uint16_t>> sampledKeys,
+                     std::vector<std::vector<std::uint16_t>> questionChoices);
+
+    // Objective value of one sheet: entropy in bits, or expected correct answers
+    double evaluate(const std::vector<std::uint16_t>& sheet, SuggestionObjective objective) const;
+
+    // Improve on start (one of the choices per question) within the
+    // options' budget and return the best sheet seen
+    std::vector<std::uint16_t> search(std::vector<std::uint16_t> start,
+                                      const SuggestionOptions& options) const;
+};
+
+#endif
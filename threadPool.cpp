@@ -0,0 +1,220 @@
+#include "threadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+ThreadPool::ThreadPool(size_t threadCount) : stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // The thread calling parallelFor does a share of the work too
+    for (size_t i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            taskAvailable.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain,
+                             const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+
+    // A few chunks per thread smooths out uneven chunk costs
+    size_t chunkCount = std::min((count + grain - 1) / grain, size() * 4);
+    if (chunkCount <= 1 || workers.empty()) {
+        body(0, count);
+        return;
+    }
+    size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+    chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    // Chunks are claimed from a shared counter by the caller and by one
+    // helper task per worker; the chunk boundaries themselves are fixed.
+    // The state lives on the heap because a helper may only get to run
+    // after every chunk is done and this call has returned.
+    struct Shared {
+        std::atomic<size_t> nextChunk{0};
+        std::atomic<size_t> finishedChunks{0};
+        std::mutex doneMutex;
+        std::condition_variable allDone;
+        std::exception_ptr error;
+    };
+    auto shared = std::make_shared<Shared>();
+    const auto* bodyPointer = &body;
+
+    auto runChunks = [shared, bodyPointer, count, chunkSize, chunkCount]() {
+        size_t chunk;
+        while ((chunk = shared->nextChunk.fetch_add(1)) < chunkCount) {
+            size_t begin = chunk * chunkSize;
+            try {
+                (*bodyPointer)(begin, std::min(count, begin + chunkSize));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(shared->doneMutex);
+                if (!shared->error) {
+                    shared->error = std::current_exception();
+                }
+            }
+            if (shared->finishedChunks.fetch_add(1) + 1 == chunkCount) {
+                std::lock_guard<std::mutex> lock(shared->doneMutex);
+                shared->allDone.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(workers.size(), chunkCount - 1);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < helpers; ++i) {
+            tasks.push(runChunks);
+        }
+    }
+    taskAvailable.notify_all();
+
+    runChunks();
+    {
+        std::unique_lock<std::mutex> lock(shared->doneMutex);
+        shared->allDone.wait(lock, [&] { return shared->finishedChunks.load() == chunkCount; });
+    }
+    if (shared->error) {
+        std::rethrow_exception(shared->error);
+    }
+}
+
+void ThreadPool::parallelForEach(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (count == 1 || workers.empty()) {
+        for (size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    // The indices a thread has yet to run; the owner takes from the front,
+    // thieves split off the back
+    struct Slice {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+    struct Shared {
+        std::vector<Slice> slices;
+        std::atomic<size_t> nextSlice{0};
+        std::atomic<size_t> finished{0};
+        std::mutex doneMutex;
+        std::condition_variable allDone;
+        std::exception_ptr error;
+
+        explicit Shared(size_t participants) : slices(participants) {}
+    };
+
+    const size_t participants = std::min(size(), count);
+    auto shared = std::make_shared<Shared>(participants);
+    for (size_t p = 0; p < participants; ++p) {
+        shared->slices[p].begin = count * p / participants;
+        shared->slices[p].end = count * (p + 1) / participants;
+    }
+    const auto* bodyPointer = &body;
+
+    auto runSlices = [shared, bodyPointer, count, participants]() {
+        const size_t self = shared->nextSlice.fetch_add(1);
+        Slice& mine = shared->slices[self];
+        while (true) {
+            size_t index = count;
+            {
+                std::lock_guard<std::mutex> lock(mine.mutex);
+                if (mine.begin < mine.end) {
+                    index = mine.begin++;
+                }
+            }
+
+            if (index == count) {
+                // Steal from the first victim with work left; give up once
+                // every slice is empty
+                bool stole = false;
+                for (size_t k = 1; k < participants && !stole; ++k) {
+                    Slice& victim = shared->slices[(self + k) % participants];
+                    size_t begin;
+                    size_t end;
+                    {
+                        std::lock_guard<std::mutex> lock(victim.mutex);
+                        if (victim.begin >= victim.end) {
+                            continue;
+                        }
+                        begin = victim.begin + (victim.end - victim.begin) / 2;
+                        end = victim.end;
+                        victim.end = begin;
+                    }
+                    std::lock_guard<std::mutex> lock(mine.mutex);
+                    mine.begin = begin;
+                    mine.end = end;
+                    stole = true;
+                }
+                if (!stole) {
+                    return;
+                }
+                continue;
+            }
+
+            try {
+                (*bodyPointer)(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(shared->doneMutex);
+                if (!shared->error) {
+                    shared->error = std::current_exception();
+                }
+            }
+            if (shared->finished.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(shared->doneMutex);
+                shared->allDone.notify_all();
+            }
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 1; i < participants; ++i) {
+            tasks.push(runSlices);
+        }
+    }
+    taskAvailable.notify_all();
+
+    runSlices();
+    {
+        std::unique_lock<std::mutex> lock(shared->doneMutex);
+        shared->allDone.wait(lock, [&] { return shared->finished.load() == count; });
+    }
+    if (shared->error) {
+        std::rethrow_exception(shared->error);
+    }
+}
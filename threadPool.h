@@ -0,0 +1,51 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool of worker threads. parallelFor splits an index range into
+// chunks whose boundaries depend only on the range and the grain, never on
+// timing, so callers that write disjoint outputs per index get the same
+// result as a serial loop.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskAvailable;
+    bool stopping;
+
+    void workerLoop();
+
+public:
+    // threadCount == 0 uses one thread per hardware core
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Run body(begin, end) over [0, count) in chunks of at least grain
+    // indices and wait for all of them. The calling thread takes part, and
+    // the first exception thrown by a chunk is rethrown here.
+    void parallelFor(size_t count, size_t grain,
+                     const std::function<void(size_t, size_t)>& body);
+
+    // Run body(i) for every i in [0, count) with work stealing: each thread
+    // starts on its own contiguous slice of indices and, once that runs
+    // out, takes the back half of another thread's remaining slice. Suits
+    // items of very uneven cost. Which thread runs an index is not fixed;
+    // exceptions are handled as in parallelFor.
+    void parallelForEach(size_t count, const std::function<void(size_t)>& body);
+
+    // Worker threads plus the calling thread
+    size_t size() const { return workers.size() + 1; }
+};
+
+#endif